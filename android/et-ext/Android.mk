@@ -19,11 +19,16 @@ LOCAL_CPPFLAGS += --std=c++11 -Wno-extern-c-compat -DDEBUG -UNDEBUG
 LOCAL_CFLAGS += -Wno-extern-c-compat -DDEBUG -UNDEBUG
 
 LOCAL_SRC_FILES = $(SOURCE_PATH)json/json.cpp \
+	$(SOURCE_PATH)scene2d/animationsystem.cpp \
 	$(SOURCE_PATH)scene2d/button.cpp \
+	$(SOURCE_PATH)scene2d/cachedlayer.cpp \
+	$(SOURCE_PATH)scene2d/chart.cpp \
 	$(SOURCE_PATH)scene2d/element.cpp \
 	$(SOURCE_PATH)scene2d/element2d.cpp \
+	$(SOURCE_PATH)scene2d/elementtree.cpp \
 	$(SOURCE_PATH)scene2d/font.cpp \
 	$(SOURCE_PATH)scene2d/fullscreenelement.cpp \
+	$(SOURCE_PATH)scene2d/hittestindex.cpp \
 	$(SOURCE_PATH)scene2d/imageview.cpp \
 	$(SOURCE_PATH)scene2d/label.cpp \
 	$(SOURCE_PATH)scene2d/layout.cpp \
@@ -31,6 +36,7 @@ LOCAL_SRC_FILES = $(SOURCE_PATH)json/json.cpp \
 	$(SOURCE_PATH)scene2d/listbox.cpp \
 	$(SOURCE_PATH)scene2d/messageview.cpp \
 	$(SOURCE_PATH)scene2d/renderingelement.cpp \
+	$(SOURCE_PATH)scene2d/renderbackend.cpp \
 	$(SOURCE_PATH)scene2d/scene.cpp \
 	$(SOURCE_PATH)scene2d/scenerenderer.cpp \
 	$(SOURCE_PATH)scene2d/scroll.cpp \
@@ -40,6 +46,7 @@ LOCAL_SRC_FILES = $(SOURCE_PATH)json/json.cpp \
 	$(SOURCE_PATH)scene2d/textureatlas.cpp \
 	$(SOURCE_PATH)scene2d/textureatlaswriter.cpp \
 	$(SOURCE_PATH)scene2d/vertexbuilder.cpp \
+	$(SOURCE_PATH)scene2d/vertexbuildpool.cpp \
 	$(SOURCE_PATH)platform-android/charactergenerator.android.cpp \
 	$(SOURCE_PATH)/atmosphere/atmosphere.cpp
 	
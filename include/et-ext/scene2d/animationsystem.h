@@ -0,0 +1,74 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/core/singleton.h>
+#include <et-ext/scene2d/baseclasses.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		class Element2d;
+
+		/*
+		 * Animates element properties. Active tweens are stored in flat arrays and advanced
+		 * in one pass per frame, each animated element is invalidated once per frame.
+		 */
+		class AnimationSystem : public Singleton<AnimationSystem>, public TimedObject
+		{
+		public:
+			void animate(Element2d*, AnimatedPropery, float& value, float to, float duration);
+			void animate(Element2d*, AnimatedPropery, vec2& value, const vec2& to, float duration);
+			void animate(Element2d*, AnimatedPropery, vec4& value, const vec4& to, float duration);
+
+			void cancelAnimation(Element2d*, AnimatedPropery);
+			void cancelAnimations(Element2d*);
+
+			size_t activeAnimationsCount() const
+				{ return _targets.size(); }
+
+		private:
+			AnimationSystem() { }
+			~AnimationSystem() { }
+
+			ET_SINGLETON_COPY_DENY(AnimationSystem)
+
+			void update(float t);
+
+			void addAnimation(Element2d*, AnimatedPropery, float* target, const vec4& from,
+				const vec4& to, size_t components, float duration);
+			void removeAnimation(size_t index);
+
+		private:
+			struct FinishedAnimation
+			{
+				Element2d* element = nullptr;
+				AnimatedPropery property = AnimatedProperty_None;
+
+				FinishedAnimation(Element2d* e, AnimatedPropery p) :
+					element(e), property(p) { }
+			};
+
+		private:
+			std::vector<vec4> _from;
+			std::vector<vec4> _delta;
+			std::vector<vec4> _values;
+			std::vector<float> _startTime;
+			std::vector<float> _inverseDuration;
+			std::vector<float> _progress;
+			std::vector<float*> _targets;
+			std::vector<size_t> _components;
+			std::vector<Element2d*> _elements;
+			std::vector<AnimatedPropery> _properties;
+
+			std::vector<Element2d*> _updatedElements;
+			std::vector<FinishedAnimation> _finishedAnimations;
+		};
+	}
+}
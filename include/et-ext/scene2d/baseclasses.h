@@ -1,10 +1,12 @@
 #pragma once
 
+#include <typeinfo>
 #include <et/rendering/texture.h>
 #include <et/rendering/program.h>
 #include <et/locale/locale.h>
 #include <et/timers/animator.h>
 #include <et-ext/scene2d/baseconst.h>
+#include <et-ext/scene2d/transform2d.h>
 
 namespace et
 {
@@ -21,8 +23,16 @@ namespace et
 			static std::string uniqueName(const std::string&);
 		};
 
+		/*
+		 * Class names are registered by ET_DECLARE_SCENE_ELEMENT_CLASS,
+		 * type name is returned for classes declared without it
+		 */
+		const std::string& registerElementClassName(const std::type_info&, const std::string&);
+		std::string elementClassName(const std::type_info&);
+
 #		define ET_DECLARE_SCENE_ELEMENT_CLASS(CLASS) template <> \
-			const std::string et::s2d::ElementClass<et::s2d::CLASS*>::className = std::string(#CLASS);\
+			const std::string et::s2d::ElementClass<et::s2d::CLASS*>::className = \
+				et::s2d::registerElementClassName(typeid(et::s2d::CLASS), std::string(#CLASS));\
 			template <> et::AtomicCounter et::s2d::ElementClass<et::s2d::CLASS*>::instanceConter = { };\
 			template <> std::string et::s2d::ElementClass<et::s2d::CLASS*>::uniqueName(const std::string& inputName)\
 			{ return (inputName.empty()) ? className + intToStr(instanceConter.retain()) : inputName; }
@@ -168,6 +178,40 @@ namespace et
 			vec4 color = vec4(0.0f);
 			vec3 position = vec3(0.0f);
 		};
+		
+		/*
+		 * position.xy - position, position.z - texCoord.zw as two 12-bit values
+		 * texCoord.xy - texCoord.xy, texCoord.zw - color as pairs of 8-bit values
+		 */
+		struct PackedSceneVertex
+		{
+			vec3 position = vec3(0.0f);
+			vec4 texCoord = vec4(0.0f);
+		};
+		
+		/*
+		 * Quad drawn as single instance, vertices are restored in vertex shader
+		 * origin.xy - first vertex, origin.zw - edge to the second vertex
+		 * axis.xy - edge to the fourth vertex, axis.z - texCoord.zw as two 12-bit values, axis.w - slot and flags
+		 * texCoord.xy - texCoord of the first vertex, texCoord.zw - of the third vertex
+		 * color.xy, color.zw - colors of the first and the third vertex as pairs of 8-bit values
+		 */
+		struct SceneQuadInstance
+		{
+			vec4 origin = vec4(0.0f);
+			vec4 axis = vec4(0.0f);
+			vec4 texCoord = vec4(0.0f);
+			vec4 color = vec4(0.0f);
+		};
+		
+		enum SceneQuadInstanceFlags : uint32_t
+		{
+			SceneQuadInstanceFlag_TransposedTexCoord = 0x01,
+			SceneQuadInstanceFlag_ColorAlongX = 0x02,
+			SceneQuadInstanceFlag_ColorAlongY = 0x04,
+			
+			SceneQuadInstance_SlotsPerFlag = 256
+		};
 
 		struct ElementDragInfo
 		{
@@ -253,12 +297,19 @@ namespace et
 		{
 			Program::Pointer program;
 			Program::Uniform additionalOffsetAndAlpha;
+			Program::Uniform objectParameters;
+			
+			/*
+			 * Assigned by scene renderer for each program name, program itself
+			 * is not created when renderer has no render context
+			 */
+			uint32_t identifier = 0;
 			
 			bool valid() const
-				{ return program.valid(); }
+				{ return identifier != 0; }
 			
 			bool invalid() const
-				{ return program.invalid(); }
+				{ return identifier == 0; }
 		};
 
 		struct LocalizedText
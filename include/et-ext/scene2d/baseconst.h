@@ -39,7 +39,25 @@ namespace et
 			Flag_ClipToBounds = 0x0020,
 			Flag_HandlesChildLayout = 0x0040,
 			Flag_DynamicRendering = 0x0080,
-			Flag_RequiresPreRendering = 0x0100
+			Flag_RequiresPreRendering = 0x0100,
+			Flag_HasObjectParameters = 0x0200,
+			Flag_CachedLayer = 0x0400
+		};
+
+		enum QuadGeometry : uint32_t
+		{
+			QuadGeometry_Vertices = 4,
+			QuadGeometry_Indices = 6,
+		};
+
+		/*
+		 * Elements with Flag_HasObjectParameters provides vec4 of parameters, which are
+		 * uploaded per render chunk as objectParameters[ObjectParameters_MaxObjects] uniform
+		 * and indexed in vertex shader with Vertex.z
+		 */
+		enum ObjectParameters : uint32_t
+		{
+			ObjectParameters_MaxObjects = 32,
 		};
 
 		enum AnimatedPropery
@@ -0,0 +1,87 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/rendering/rendercontext.h>
+#include <et-ext/scene2d/scenerenderer.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Children are rendered in layer space into offscreen texture, which is drawn as a single quad.
+		 * Texture is rendered again only when something inside of layer is invalidated,
+		 * transform and alpha of the layer itself are applied to the quad only.
+		 * Pointer events are passed to children in layer space.
+		 */
+		class CachedLayer : public Element2d
+		{
+		public:
+			ET_DECLARE_POINTER(CachedLayer)
+
+		public:
+			CachedLayer(Element2d* parent, const std::string& name = emptyString);
+
+			bool layerValid() const;
+
+			/*
+			 * Called by scene before layouts are built, renders children if layer is not valid.
+			 * Returns true if projection of the renderer was changed
+			 */
+			bool renderLayer(RenderContext* rc, SceneRenderer& r);
+
+			const Framebuffer::Pointer& framebuffer() const
+				{ return _framebuffer; }
+
+		protected:
+			void addToRenderQueue(RenderContext*, SceneRenderer&);
+
+			SceneProgram initProgram(SceneRenderer&);
+
+			const Transform2d& finalTransform();
+			const Transform2d& finalInverseTransform();
+
+			size_t contentStampForChildren()
+				{ return 0; }
+
+			size_t transformStampForChildren()
+				{ return 0; }
+
+			float alphaForChildren()
+				{ return 1.0f; }
+
+			void setInvalid();
+			void subtreeHierarchyChanged();
+
+			bool pointerPressed(const PointerInputInfo&);
+			bool pointerMoved(const PointerInputInfo&);
+			bool pointerReleased(const PointerInputInfo&);
+			bool pointerCancelled(const PointerInputInfo&);
+			bool pointerScrolled(const PointerInputInfo&);
+
+		private:
+			void buildVertices();
+			void addChildToRenderQueue(Element2d*, RenderContext*, SceneRenderer&);
+
+			Element2d* getActiveElement(const vec2& p, Element2d* root);
+			PointerInputInfo pointerInElement(const PointerInputInfo&, Element2d*);
+
+		private:
+			Framebuffer::Pointer _framebuffer;
+			RenderingElement::Pointer _renderingElement;
+			SceneVertexList _vertices;
+			Element2d::Pointer _capturedElement;
+
+			Transform2d _childrenTransform;
+			Transform2d _localInverseTransform;
+
+			bool _layerValid = false;
+		};
+	}
+}
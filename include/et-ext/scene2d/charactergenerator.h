@@ -61,11 +61,23 @@ namespace et
 			static const vec2i charactersRenderingExtent;
 			
 		public:
+			/*
+			 * Without render context glyphs are kept in memory only and texture is not created
+			 */
 			CharacterGenerator(RenderContext*, const std::string& face, const std::string& boldFace, 
 				size_t faceIndex = 0, size_t boldFaceIndex = 0);
 			
 			const Texture::Pointer& texture() const
 				{ return _texture; }
+			
+			const BinaryDataStorage& textureData() const
+				{ return _textureData; }
+			
+			vec2i textureSize() const
+				{ return _texture.valid() ? _texture->size() : _textureDataSize; }
+			
+			vec2 texel() const
+				{ return vec2(1.0f) / vector2ToFloat(textureSize()); }
 
 			const std::string& face() const
 				{ return _fontFace; }
@@ -97,12 +109,16 @@ namespace et
 			void setTexture(Texture::Pointer);
 			void pushCharacter(const CharDescriptor&);
 			
+			/*
+			 * Converts w x h 8-bit coverage data to distance field in place
+			 */
+			void generateSignedDistanceField(BinaryDataStorage&, int, int);
+			
 			ET_DECLARE_EVENT1(characterGenerated, int)
 
 		private:
 			CharDescriptor generateCharacter(int, CharacterFlags);
 			
-			void generateSignedDistanceField(BinaryDataStorage&, int, int);
 			void generateSignedDistanceFieldOnGrid(sdf::Grid&);
 			
 			bool performCropping(const BinaryDataStorage&, const vec2i&, BinaryDataStorage&, vec2i&, vec2i&);
@@ -117,6 +133,8 @@ namespace et
 			RenderContext* _rc = nullptr;
 			
 			et::Texture::Pointer _texture;
+			BinaryDataStorage _textureData;
+			vec2i _textureDataSize;
 			std::string _fontFace;
 			std::string _fontBoldFace;
 			RectPlacer _placer;
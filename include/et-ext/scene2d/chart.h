@@ -0,0 +1,138 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et-ext/scene2d/element2d.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Plots series of values appended over time. Samples are kept in ring buffers,
+		 * every column of the chart is drawn as a single quad covering min and max of its samples.
+		 * Column summaries are updated on append and rebuilt from stored samples (bounded by capacity)
+		 * only when amount of samples per column changes. Columns are written to ring of slots
+		 * and shifted to their positions in vertex shader, so appended samples only rebuild new columns.
+		 */
+		class Chart : public Element2d
+		{
+		public:
+			ET_DECLARE_POINTER(Chart)
+
+			enum : size_t
+			{
+				DefaultCapacity = 131072,
+				DefaultVisibleSamples = 1024
+			};
+
+		public:
+			Chart(Element2d* parent, const std::string& name = emptyString);
+
+			/*
+			 * Returns index of the new series, capacity is amount of the latest samples kept
+			 */
+			size_t addSeries(const vec4& color, size_t capacity = DefaultCapacity);
+			void clearSeries(size_t);
+			void setSeriesColor(size_t, const vec4&);
+
+			size_t seriesCount() const
+				{ return _series.size(); }
+
+			size_t samplesCount(size_t) const;
+
+			void appendValue(size_t series, float);
+			void appendValues(size_t series, const float*, size_t count);
+
+			/*
+			 * Values are mapped to the chart height and clamped to the range
+			 */
+			void setValueRange(float minValue, float maxValue);
+			void setLineWidth(float);
+
+			/*
+			 * Amount of samples fitted in the chart width, when it exceeds width in pixels
+			 * every pixel column contains several samples
+			 */
+			void setVisibleSamples(size_t);
+
+			size_t visibleSamples() const
+				{ return _visibleSamples; }
+
+			/*
+			 * Amount of samples between the latest one and the right edge, rounded to columns.
+			 * Zero follows appended samples
+			 */
+			void setScrollOffset(size_t);
+
+			size_t scrollOffset() const
+				{ return _scrollOffset; }
+
+			/*
+			 * xy - width of the column in scene space, z - slot of the first visible column, w - slots count
+			 */
+			vec4 objectParameters() override;
+
+		private:
+			struct Column
+			{
+				float minValue = 0.0f;
+				float maxValue = 0.0f;
+				float lastValue = 0.0f;
+			};
+
+			struct Series
+			{
+				std::vector<float> samples;
+				std::vector<Column> columns;
+				SceneVertexList vertices;
+				vec4 color;
+				size_t samplesCount = 0;
+				size_t dirtyColumn = 0;
+				size_t builtFirstColumn = 0;
+				size_t builtColumns = 0;
+				size_t ringPhase = 0;
+			};
+
+		private:
+			void addToRenderQueue(RenderContext*, SceneRenderer&);
+			void buildVertices(bool fixedSlots);
+			const SceneProgram& chartProgram(SceneRenderer&);
+
+			void addSampleToColumn(Series&, size_t index, float value, bool startsColumn);
+			void buildColumnSummaries(Series&);
+			void buildSeriesVertices(Series&, bool rebuild, const vec4& color, const Transform2d&);
+			void buildColumnVertices(Series&, size_t column, size_t firstColumn, const vec4& color, const Transform2d&);
+
+			bool visibleColumnsRange(const Series&, size_t& firstColumn, size_t& lastColumn) const;
+			size_t oldestSample(const Series&) const;
+			float valueToPosition(float) const;
+
+		private:
+			std::vector<Series> _series;
+			SceneProgram _chartProgram;
+
+			vec4 _builtColor;
+			vec2 _builtSize;
+			vec2 _valueRange = vec2(0.0f, 1.0f);
+			vec2 _columnAxis;
+
+			size_t _visibleSamples = DefaultVisibleSamples;
+			size_t _scrollOffset = 0;
+			size_t _samplesPerColumn = 0;
+			size_t _visibleColumns = 0;
+			size_t _builtTransformStamp = 0;
+			size_t _ringHead = 0;
+
+			float _lineWidth = 1.0f;
+			float _columnWidth = 1.0f;
+
+			bool _layoutValid = false;
+		};
+	}
+}
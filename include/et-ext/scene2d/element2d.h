@@ -9,7 +9,7 @@
 
 #include <et/input/input.h>
 #include <et/rendering/program.h>
-#include <et-ext/scene2d/baseclasses.h>
+#include <et-ext/scene2d/animationsystem.h>
 
 namespace et
 {
@@ -35,14 +35,55 @@ namespace et
 		public:
 			Element2d(Element2d* parent, const std::string& name = emptyString);
 			Element2d(const rect& frame, Element2d* parent, const std::string& name = emptyString);
+			~Element2d();
 			
 			void setParent(Element2d* element);
 			
-			bool contentValid() const
-				{ return _contentValid; }
+			/*
+			 * Incremented whenever any element is added, removed or reordered
+			 */
+			static size_t hierarchyVersion();
+			
+			/*
+			 * FlagsHolder methods are hidden, so flag changes could be tracked by scene
+			 */
+			void setFlag(size_t flag);
+			void setFlags(size_t flags);
+			void removeFlag(size_t flag);
+			
+			/*
+			 * Incremented whenever flags of any element are changed
+			 */
+			static size_t flagsVersion();
+			
+			/*
+			 * Invalidation only stamps the element itself, children compare their
+			 * stamps with inherited ones, which are resolved lazily top-down
+			 */
+			bool contentValid()
+				{ return _validContentStamp >= effectiveContentStamp(); }
 			
 			void invalidateContent();
 			
+			/*
+			 * Unique stamp, updated when element is invalidated and when its content
+			 * is validated after invalidation of element itself or any of its parents
+			 */
+			size_t contentVersion() const
+				{ return _contentVersion; }
+			
+			/*
+			 * Latest stamp issued to any element, changes on every invalidation
+			 */
+			static size_t invalidationStamp();
+			
+			/*
+			 * Incremented whenever transform of any element is invalidated
+			 */
+			static size_t transformVersion();
+			
+			size_t effectiveTransformStamp();
+			
 			const ElementLayout& autoLayout() const
 				{ return _autoLayout; }
 			
@@ -104,6 +145,24 @@ namespace et
 			virtual void setDefaultProgram(et::Program::Pointer&) { }
 			virtual void setProgramParameters(et::RenderContext*, et::Program::Pointer&) { }
 			
+			/*
+			 * Called for elements with Flag_HasObjectParameters,
+			 * result is available in vertex shader as objectParameters[int(Vertex.z)]
+			 */
+			virtual vec4 objectParameters()
+				{ return vec4(0.0f); }
+			
+			/*
+			 * Elements which build vertices from own state only, without GL calls
+			 * and glyph generation, could be rebuilt on worker threads.
+			 * buildVerticesInParallel is called only when content or transform is invalid,
+			 * final transform and alpha are already calculated on the main thread
+			 */
+			virtual bool supportsParallelVertexBuild() const
+				{ return false; }
+			
+			virtual void buildVerticesInParallel(RenderContext*, SceneRenderer&) { }
+			
 			virtual bool pointerPressed(const PointerInputInfo& info) 
 				{ onPointerPressed.invoke(info); return !hasFlag(Flag_TransparentForPointer); }
 
@@ -126,6 +185,12 @@ namespace et
 			virtual bool containsPoint(const vec2& p, const vec2&);
 			virtual bool containLocalPoint(const vec2& p);
 			
+			/*
+			 * Screen-space bounds of points accepted by containsPoint, cached by layout hit-test index
+			 * until transform of element changes. Elements which could not provide them return false
+			 */
+			virtual bool hitTestBounds(rect& bounds);
+			
 			vec2 positionInElement(const vec2& p);
 			
 			virtual Layout* owner()
@@ -141,23 +206,8 @@ namespace et
 			T* childWithName(const std::string& name, bool recursive)
 				{ return static_cast<T*>(baseChildWithName(name, recursive)); }
 			
-			/*
-			 * Animator accessors
-			 */
-			Vector2Animator& positionAnimator()
-				{ return _positionAnimator; }
-			
-			Vector2Animator& sizeAnimator()
-				{ return _sizeAnimator; }
-			
-			Vector4Animator& colorAnimator()
-				{ return _colorAnimator; }
-			
-			Vector2Animator& scaleAnimator()
-				{ return _scaleAnimator; }
-			
-			FloatAnimator& angleAnimator()
-				{ return _angleAnimator; }
+			bool isAnimating(AnimatedPropery p) const
+				{ return _animationSlots[p] > 0; }
 
 			rect frame() const;
 			vec2 origin() const;
@@ -218,13 +268,13 @@ namespace et
 			/*
 			 * Transformations
 			 */
-			const mat4& transform();
+			const Transform2d& transform();
 			
-			virtual const mat4& finalTransform();
-			virtual const mat4& finalInverseTransform();
+			virtual const Transform2d& finalTransform();
+			virtual const Transform2d& finalInverseTransform();
 			
-			bool transformValid() const
-				{ return _transformValid; }
+			bool transformValid()
+				{ return _validTransformStamp >= effectiveTransformStamp(); }
 			
 			void invalidateTransform();
 			
@@ -248,9 +298,8 @@ namespace et
 			ET_DECLARE_EVENT1(onPointerCancelled, const PointerInputInfo&);
 
 		protected:
-			void initAnimators();
 			void buildFinalTransform();
-			mat4 buildFinalTransform(const vec2& aOffset, float aAngle, const vec2& aScale, const vec2& aPosition);
+			Transform2d buildFinalTransform(const vec2& aOffset, float aAngle, const vec2& aScale, const vec2& aPosition);
 			
 			virtual SceneProgram initProgram(SceneRenderer&);
 			virtual void setDefaultProgram(const SceneProgram&);
@@ -262,23 +311,43 @@ namespace et
 			 */
 			void childRemoved(Element2d*);
 			
-			void setContentValid()
-				{ _contentValid = true; }
+			void setContentValid();
 			
 			bool inverseTransformValid()
-				{ return _inverseTransformValid; }
+				{ return _validInverseTransformStamp >= effectiveTransformStamp(); }
+			
+			virtual void setInvalid();
 			
-			virtual void setInvalid()
-				{ if (parent()) parent()->setInvalid(); }
+			/*
+			 * Called when layout is built, invalidations after it are propagated to the layout again
+			 */
+			static void startInvalidationPropagation();
+			
+			size_t effectiveContentStamp();
+			
+			virtual Transform2d parentFinalTransform()
+				{ return parent() ? parent()->finalTransform() : Transform2d(); }
+			
+			/*
+			 * Stamps and alpha inherited by children, element rendering children
+			 * in its own space could isolate them from its own changes
+			 */
+			virtual size_t contentStampForChildren()
+				{ return effectiveContentStamp(); }
 			
-			void setTransformValid(bool v)
-				{ _transformValid = v; }
+			virtual size_t transformStampForChildren()
+				{ return effectiveTransformStamp(); }
 			
-			void setInverseTransformValid(bool v)
-				{ _inverseTransformValid = v; }
+			virtual float alphaForChildren()
+				{ return finalAlpha(); }
 			
-			virtual mat4 parentFinalTransform()
-				{ return parent() ? parent()->finalTransform() : identityMatrix; }
+			size_t ownInvalidationStamp() const
+				{ return etMax(_contentStamp, _transformStamp); }
+			
+			/*
+			 * Called on cached layers when element is added, removed or reordered within their subtree
+			 */
+			virtual void subtreeHierarchyChanged() { }
 						
 			Element2d* childWithNameCallback(const std::string&, Element2d*, bool recursive);
 			
@@ -286,31 +355,44 @@ namespace et
 			
 		private:
 			friend class Hierarchy<Element2d, LoadableObject>;
+			friend class AnimationSystem;
 			ET_DENY_COPY(Element2d)
 			
-			Vector2Animator _positionAnimator;
-			Vector2Animator _sizeAnimator;
-			Vector4Animator _colorAnimator;
-			Vector2Animator _scaleAnimator;
-			FloatAnimator _angleAnimator;
+			void resolveInheritedStamps();
+			void hierarchyChanged();
 			
 			SceneProgram _defaultProgram;
 			
-			mat4 _transform = identityMatrix;
-			mat4 _finalTransform = identityMatrix;
-			mat4 _finalInverseTransform = identityMatrix;
+			Transform2d _transform;
+			Transform2d _finalTransform;
+			Transform2d _finalInverseTransform;
 			
 			ElementLayout _layout;
 			ElementLayout _autoLayout;
 			ElementLayout _desiredLayout;
 			
+			vec4 _color = vec4(1.0f);
 			float _finalAlpha = 1.0f;
+			size_t _contentVersion = 0;
+			
+			size_t _contentStamp = 0;
+			size_t _transformStamp = 0;
+			size_t _validContentStamp = 0;
+			size_t _validTransformStamp = 0;
+			size_t _validInverseTransformStamp = 0;
+			size_t _validAlphaStamp = 0;
+			size_t _inheritedContentStamp = 0;
+			size_t _inheritedTransformStamp = 0;
+			size_t _inheritedStampsResolvedAt = 0;
+			size_t _propagationGeneration = 0;
+			
+			/*
+			 * Index + 1 of active animation in AnimationSystem, zero if property is not animated
+			 */
+			size_t _animationSlots[AnimatedProperty_max] = { };
+			size_t _pendingAnimatedProperties = 0;
 			
 			bool _enabled = true;
-			bool _transformValid = false;
-			bool _inverseTransformValid = false;
-			bool _contentValid = false;
-			bool _finalAlphaValid = false;
 			bool _focused = false;
 		};
 		
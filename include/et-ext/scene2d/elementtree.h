@@ -0,0 +1,83 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et-ext/scene2d/element2d.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Pre-order snapshot of element hierarchy stored in flat arrays.
+		 * Structure is rebuilt only when hierarchy changes, visibility and flags
+		 * used by whole-tree passes are refreshed in one linear pass.
+		 *
+		 * Only structure, visibility and flags are flattened. Final transforms, frames and alpha
+		 * stay in stamp-validated caches of elements: resolving final transform marks it valid,
+		 * which elements use to decide on rebuilding vertices, and finalTransform / alphaForChildren
+		 * are overridden by elements like CachedLayer. Visibility is still read from element alpha.
+		 */
+		class ElementTree
+		{
+		public:
+			enum : uint32_t
+			{
+				InvalidIndex = static_cast<uint32_t>(-1),
+			};
+
+			enum : uint32_t
+			{
+				NodeFlag_Visible = 0x01,
+				NodeFlag_ClipToBounds = 0x02,
+				NodeFlag_RenderTopmost = 0x04,
+				NodeFlag_RequiresPreRendering = 0x08,
+				NodeFlag_CachedLayer = 0x10,
+			};
+
+		public:
+			/*
+			 * Root element itself is not included
+			 */
+			void build(Element2d* root);
+
+			bool outdated() const
+				{ return _hierarchyVersion != Element2d::hierarchyVersion(); }
+
+			void refreshState();
+
+			uint32_t indexOf(const Element2d*) const;
+
+			size_t size() const
+				{ return _elements.size(); }
+
+			Element2d* element(uint32_t i) const
+				{ return _elements[i]; }
+
+			uint32_t parent(uint32_t i) const
+				{ return _parent[i]; }
+
+			uint32_t subtreeEnd(uint32_t i) const
+				{ return _subtreeEnd[i]; }
+
+			bool hasFlag(uint32_t i, uint32_t flag) const
+				{ return (_nodeFlags[i] & flag) == flag; }
+
+		private:
+			void addSubtree(Element2d*, uint32_t parent);
+
+		private:
+			std::vector<Element2d*> _elements;
+			std::vector<uint32_t> _parent;
+			std::vector<uint32_t> _subtreeEnd;
+			std::vector<uint32_t> _nodeFlags;
+
+			size_t _hierarchyVersion = 0;
+		};
+	}
+}
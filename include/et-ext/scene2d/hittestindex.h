@@ -0,0 +1,73 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et-ext/scene2d/elementtree.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Uniform grid of screen-space hit-test bounds of elements from ElementTree.
+		 * Candidates for a point are conservative: element outside of them could not contain the point.
+		 * Bounds are recalculated and moved between cells only for elements with changed transforms,
+		 * all elements are bucketed again only when hierarchy or area changes.
+		 */
+		class HitTestIndex
+		{
+		public:
+			bool outdated() const
+			{
+				return (_hierarchyVersion != Element2d::hierarchyVersion()) ||
+					(_transformVersion != Element2d::transformVersion());
+			}
+
+			void build(const ElementTree& tree, const vec2& area);
+
+			/*
+			 * Indices of elements in tree, sorted in ascending (pre-order) order
+			 */
+			const std::vector<uint32_t>& candidates(const vec2& p);
+
+		private:
+			enum : uint32_t
+			{
+				CellSize = 64,
+			};
+
+			struct CellRange
+			{
+				int x0 = 0;
+				int y0 = 0;
+				int x1 = 0;
+				int y1 = 0;
+			};
+
+			int cellCoord(float value, int cells) const;
+			CellRange cellRange(const rect& bounds) const;
+
+			void addToCells(uint32_t);
+			void removeFromCells(uint32_t);
+
+		private:
+			std::vector<rect> _bounds;
+			std::vector<size_t> _boundsStamp;
+			std::vector<Element2d*> _boundsElement;
+			std::vector<bool> _bounded;
+
+			std::vector<std::vector<uint32_t>> _cells;
+			std::vector<uint32_t> _unbounded;
+			std::vector<uint32_t> _candidates;
+
+			vec2i _gridSize = vec2i(0);
+			size_t _hierarchyVersion = 0;
+			size_t _transformVersion = 0;
+		};
+	}
+}
@@ -62,6 +62,26 @@ namespace et
 			void setImage(const Image& img);
 			void setBackgroundColor(const vec4& color, float duration = 0.0f);
 			
+			/*
+			 * Nine-slice image is drawn as single quad, slices are resolved in fragment shader.
+			 * Falls back to regular geometry for tiled images, images smaller than their borders
+			 * and layouts with vertex format other than default
+			 */
+			void setShaderNineSlice(bool);
+			
+			bool shaderNineSlice() const
+				{ return _shaderNineSlice; }
+			
+			/*
+			 * Tiled image is drawn as single quad, texCoords are wrapped within image rect in fragment shader.
+			 * Falls back to quad per tile for nine-slice images and layouts with vertex format other than default.
+			 * Texture should not use mipmaps, since wrapping breaks texCoord derivatives on tile edges
+			 */
+			void setShaderTiling(bool);
+			
+			bool shaderTiling() const
+				{ return _shaderTiling; }
+			
 			vec2 contentSize();
 
 			ImageDescriptor calculateImageFrame();
@@ -72,18 +92,42 @@ namespace et
 		public:
 			void addToRenderQueue(RenderContext*, SceneRenderer&);
 			
+			bool supportsParallelVertexBuild() const override
+				{ return true; }
+			
+			void buildVerticesInParallel(RenderContext* rc, SceneRenderer& r) override
+				{ buildVertices(rc, r); }
+			
+			vec4 objectParameters() override
+				{ return _shaderParameters; }
+			
 		private:
 			void connectEvents();
 			
 			void buildVertices(RenderContext*, SceneRenderer&);
+			
+			bool defaultVertexFormat(SceneRenderer&) const;
+			bool shouldUseShaderNineSlice(SceneRenderer&, const ImageDescriptor&) const;
+			bool shouldUseShaderTiling(SceneRenderer&, const ImageDescriptor&) const;
+			void updateObjectParametersFlag();
+			
+			const SceneProgram& nineSliceProgram(SceneRenderer&);
+			const SceneProgram& tilingProgram(SceneRenderer&);
 
 		private:
 			Texture::Pointer _texture;
 			SceneVertexList _vertices;
+			SceneVertexList _shaderVertices;
+			SceneProgram _nineSliceProgram;
+			SceneProgram _tilingProgram;
 			Animator<ImageDescriptor> _descriptor;
 			Vector4Animator _backgroundColorAnimator;
 			vec4 _backgroundColor = vec4(0.0f);
+			vec4 _shaderParameters = vec4(0.0f);
 			ContentMode _contentMode = ContentMode_Stretch;
+			bool _shaderNineSlice = false;
+			bool _shaderTiling = false;
+			bool _shaderVerticesTiled = false;
 		};
 
 		typedef std::vector<ImageView::Pointer> ImageViewList;
@@ -58,6 +58,12 @@ namespace et
 			void setLineInterval(float);
 			
 			void processMessage(const Message&);
+			
+			bool supportsParallelVertexBuild() const override
+				{ return true; }
+			
+			void buildVerticesInParallel(RenderContext* rc, SceneRenderer& renderer) override
+				{ buildVertices(rc, renderer); }
 
 		private:
 			void addToRenderQueue(RenderContext* rc, SceneRenderer& renderer);
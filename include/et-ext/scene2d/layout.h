@@ -9,6 +9,7 @@
 
 #include <et-ext/scene2d/element2d.h>
 #include <et-ext/scene2d/imageview.h>
+#include <et-ext/scene2d/hittestindex.h>
 
 namespace et
 {
@@ -45,6 +46,27 @@ namespace et
 				{ return _positionInterpolationFunction; }
 			
 			Element2d::Pointer findFirstResponder(const Message&);
+			
+			/*
+			 * Vertex format, streaming mode and initial vertex capacity
+			 * should be set before layout is added to the scene.
+			 * Layouts use persistent streaming by default
+			 */
+			void setVertexFormat(RenderingElement::VertexFormat);
+			void setStreamingMode(RenderingElement::StreamingMode);
+			void setVertexCapacity(size_t);
+			
+			RenderingElement::VertexFormat vertexFormat() const
+				{ return _vertexFormat; }
+			
+			RenderingElement::StreamingMode streamingMode() const
+				{ return _streamingMode; }
+			
+			size_t vertexCapacity() const
+				{ return _renderingElement.valid() ? _renderingElement->capacity() : _vertexCapacity; }
+			
+			size_t vertexHighWaterMark() const
+				{ return _renderingElement.valid() ? _renderingElement->highWaterMark() : 0; }
 						
 		public:
 			virtual void activeElementChanged(Element2d*) { }
@@ -55,7 +77,9 @@ namespace et
 			RenderingElement::Pointer renderingElement()
 				{ return _renderingElement; }
 			
-			void initRenderingElement(RenderContext* rc);
+			void initRenderingElement(RenderContext* rc, const RenderBackend::Pointer& backend);
+			
+			Element2d::Pointer activeElement(const PointerInputInfo& p);
 			
 			bool pointerPressed(const PointerInputInfo&);
 			bool pointerMoved(const PointerInputInfo&);
@@ -63,7 +87,7 @@ namespace et
 			bool pointerCancelled(const PointerInputInfo&);
 			bool pointerScrolled(const PointerInputInfo&);
 			
-			bool elementIsBeingDragged(Element2d::Pointer);
+			bool elementIsBeingDragged(const Element2d*);
 			
 			void cancelInteractionsInElement(Element2d::Pointer, const PointerInputInfo&);
 			
@@ -74,18 +98,31 @@ namespace et
 				{ return this; }
 			
 			void setInvalid();
-			void collectTopmostElements(Element2d::Pointer);
 			
-			void collectPreRenderingObjects(Element2d::Pointer, Element2d::List&);
+			/*
+			 * Rebuilds flat tree if hierarchy was changed and refreshes state of its elements
+			 */
+			void updateElementTree();
 			
-			Element2d::Pointer activeElement(const PointerInputInfo& p);
-			Element2d::Pointer getActiveElement(const PointerInputInfo& p, Element2d::Pointer e);
+			void collectPreRenderingObjects(std::vector<Element2d*>&, std::vector<Element2d*>& cachedLayers);
+			
+			Element2d::Pointer getActiveElement(const PointerInputInfo& p, const std::vector<uint32_t>& candidates,
+				size_t position);
 			
 			void setCurrentElement(const PointerInputInfo& p, Element2d::Pointer e);
 			void performDragging(const PointerInputInfo&);
 
 			void addToRenderQueue(RenderContext* rc, SceneRenderer& gr);
-			void addElementToRenderQueue(Element2d::Pointer& element, RenderContext* rc, SceneRenderer& gr);
+			void addElementToRenderQueue(uint32_t index, RenderContext* rc, SceneRenderer& gr);
+			
+			void buildVerticesInParallel(RenderContext* rc, SceneRenderer& gr);
+			void collectParallelBuildElements();
+			
+		private:
+			enum : uint32_t
+			{
+				MinParallelBuildElements = 32,
+			};
 			
 		private:
 			RenderingElement::Pointer _renderingElement;
@@ -95,11 +132,18 @@ namespace et
 			Element2d::Pointer _currentElement;
 			Element2d::Pointer _focusedElement;
 			Element2d::Pointer _capturedElement;
-			Element2d::List _topmostElements;
+			ElementTree _elementTree;
+			HitTestIndex _hitTestIndex;
+			std::vector<uint32_t> _topmostElements;
+			std::vector<Element2d*> _parallelBuildElements;
 			
 			vec2 _dragInitialPosition;
 			vec2 _dragInitialOffset;
 			
+			RenderingElement::VertexFormat _vertexFormat = RenderingElement::VertexFormat::Default;
+			RenderingElement::StreamingMode _streamingMode = RenderingElement::StreamingMode::Persistent;
+			size_t _vertexCapacity = RenderingElement::DefaultCapacity;
+			
 			bool _valid;
 			bool _dragging;
 		};
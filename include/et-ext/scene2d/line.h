@@ -13,6 +13,10 @@ namespace et
 {
 	namespace s2d
 	{
+		/*
+		 * Strip is built from rectangular segments and parallelogram joints on the outer side of turns,
+		 * so it is drawn correctly with instanced vertex format, which restores quads as parallelograms
+		 */
 		class Line : public Element2d
 		{
 		public:
@@ -31,6 +35,11 @@ namespace et
 			void setControlPoint(size_t index, const vec2&);
 			void setWidth(float);
 			
+			/*
+			 * Maximal distance in pixels between curve and its tessellated polyline
+			 */
+			void setTolerance(float);
+			
 			void setGradientColors(const vec4&, const vec4&);
 			
 			void setShadowColor(const vec4&);
@@ -40,17 +49,29 @@ namespace et
 			void addToRenderQueue(RenderContext*, SceneRenderer&);
 			void buildVertices(SceneRenderer&);
 			
-			void buildLine(const vec2&, const vec2&, const vec4&, const vec4&, const vec4&, const mat4&);
+			void buildCurve();
+			void tessellateCurve(float t0, const vec2& p0, float t1, const vec2& p1, size_t depth);
+			void buildStrip(const vec2& offset, const vec4& clr1, const vec4& clr2, const vec4& tc, const Transform2d&);
+			void buildJoint(const vec2&, const vec2& n1, const vec2& n2, const vec4& clr, const vec4& tc, const Transform2d&);
+			
+			vec2 curvePoint(float t) const;
 			
 		private:
 			std::vector<vec2> _controlPoints;
+			std::vector<vec2> _curvePoints;
+			std::vector<float> _curveParameters;
+			std::vector<vec2> _curveNormals;
 			SceneVertexList _vertices;
 			vec4 _startColor;
 			vec4 _endColor;
 			vec4 _shadowColor;
 			vec2 _shadowOffset;
+			vec2 _curveOrigin;
+			vec2 _curveSize;
 			float _width = 1.0f;
+			float _tolerance = 0.25f;
 			Type _type = Type_Linear;
+			bool _curveValid = false;
 		};
 	}
 }
@@ -79,6 +79,7 @@ namespace et
 			void setPopupDirection(ListboxPopupDirection d);
 
 			bool containsPoint(const vec2& p, const vec2&);
+			bool hitTestBounds(rect&);
 
 			bool pointerPressed(const PointerInputInfo&);
 			bool pointerMoved(const PointerInputInfo&);
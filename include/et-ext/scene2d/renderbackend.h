@@ -0,0 +1,111 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et-ext/scene2d/baseclasses.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		struct RenderChunk;
+		class RenderingElement;
+
+		/*
+		 * When render backend is set, rendering elements keep vertices in memory only
+		 * and pass uploads and draw calls to the backend instead of GPU.
+		 * Scene created with backend and without render context does not compile programs
+		 * and keeps glyphs of character generators created without render context in memory
+		 */
+		class RenderBackend : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(RenderBackend)
+
+		public:
+			virtual ~RenderBackend() { }
+
+			/*
+			 * Data is valid only during the call, offset and size are in bytes
+			 */
+			virtual void uploadVertices(const RenderingElement*, size_t offset, const void* data, size_t size) = 0;
+
+			/*
+			 * First index already includes base index of the rendering element
+			 */
+			virtual void drawChunk(const RenderingElement*, const RenderChunk&, size_t firstIndex,
+				const vec4* objectParameters, size_t objectParametersCount) = 0;
+
+			/*
+			 * Used for instanced vertex format, where each quad of the chunk is an instance.
+			 * First instance already includes base of the rendering element
+			 */
+			virtual void drawInstances(const RenderingElement*, const RenderChunk&, size_t firstInstance,
+				size_t instanceCount, const vec4* objectParameters, size_t objectParametersCount) = 0;
+		};
+
+		/*
+		 * Records uploads and draw calls, could be used to run scene without GPU
+		 * and to inspect its vertex traffic and draw submission
+		 */
+		class RecordingRenderBackend : public RenderBackend
+		{
+		public:
+			ET_DECLARE_POINTER(RecordingRenderBackend)
+
+			struct Upload
+			{
+				const RenderingElement* element = nullptr;
+				size_t offset = 0;
+				size_t size = 0;
+			};
+
+			struct Draw
+			{
+				const RenderingElement* element = nullptr;
+				size_t firstIndex = 0;
+				size_t indexCount = 0;
+
+				/*
+				 * Set only for instanced vertex format
+				 */
+				size_t firstInstance = 0;
+				size_t instanceCount = 0;
+				recti clip;
+				Texture::Pointer texture;
+				SceneProgram program;
+				size_t objectParametersCount = 0;
+			};
+
+		public:
+			void uploadVertices(const RenderingElement*, size_t offset, const void* data, size_t size) override;
+
+			void drawChunk(const RenderingElement*, const RenderChunk&, size_t firstIndex,
+				const vec4* objectParameters, size_t objectParametersCount) override;
+
+			void drawInstances(const RenderingElement*, const RenderChunk&, size_t firstInstance,
+				size_t instanceCount, const vec4* objectParameters, size_t objectParametersCount) override;
+
+			void clear();
+
+			const std::vector<Upload>& uploads() const
+				{ return _uploads; }
+
+			const std::vector<Draw>& draws() const
+				{ return _draws; }
+
+			size_t uploadedBytes() const
+				{ return _uploadedBytes; }
+
+		private:
+			std::vector<Upload> _uploads;
+			std::vector<Draw> _draws;
+			size_t _uploadedBytes = 0;
+		};
+	}
+}
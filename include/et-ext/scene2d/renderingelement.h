@@ -7,8 +7,11 @@
 
 #pragma once
 
+#include <map>
+#include <unordered_map>
 #include <et/rendering/vertexarrayobject.h>
 #include <et-ext/scene2d/element2d.h>
+#include <et-ext/scene2d/renderbackend.h>
 
 namespace et
 {
@@ -18,16 +21,61 @@ namespace et
 		{
 			size_t first = 0;
 			size_t count = 0;
-			PrimitiveType primitiveType = PrimitiveType::Triangles;
+			
+			/*
+			 * Vertices written by elements, unused reserve of persistent ranges is not included
+			 */
+			size_t vertices = 0;
 			
 			recti clip;
 			
+			/*
+			 * Screen-space bounds of chunk vertices, filled only when renderer tracks damage
+			 */
+			rect bounds = rect(0.0f, 0.0f, 0.0f, 0.0f);
+			
 			Texture::Pointer texture;
 			SceneProgram program;
 			Element2d* object = nullptr;
 			
+			Element2d* parameterObjects[ObjectParameters_MaxObjects] = { };
+			size_t parameterObjectsCount = 0;
+			
 			RenderChunk(size_t aFirst, size_t aCount, const recti& aClip, const Texture::Pointer& aTexture,
-				const SceneProgram& aProgram, Element2d* aObject, PrimitiveType pt);
+				const SceneProgram& aProgram, Element2d* aObject);
+			
+			/*
+			 * Returns ObjectParameters_MaxObjects if there is no free slot in chunk
+			 */
+			size_t slotForObject(Element2d*);
+		};
+		
+		/*
+		 * Times are in milliseconds, rebuilt elements are counted once per frame
+		 * and grouped by class name of the element. Drawn vertices include only chunks
+		 * submitted for drawing, without unused reserve of persistent ranges
+		 */
+		struct RenderStatistics
+		{
+			size_t chunks = 0;
+			size_t drawCalls = 0;
+			size_t uploadedVertices = 0;
+			size_t drawnVertices = 0;
+			size_t textureSwitches = 0;
+			size_t programSwitches = 0;
+			size_t clipSwitches = 0;
+			size_t rebuiltElements = 0;
+			
+			double addToRenderQueueTime = 0.0;
+			double commitTime = 0.0;
+			double renderTime = 0.0;
+			
+			std::map<std::string, size_t> rebuiltElementTypes;
+			
+			void append(const RenderStatistics&);
+			Dictionary dictionary() const;
+			
+			static double currentTime();
 		};
 		
 		class RenderingElement : public Shared
@@ -35,39 +83,204 @@ namespace et
 		public:
 			ET_DECLARE_POINTER(RenderingElement)
 			
+			/*
+			 * Storage grows on demand, when capacity exceeds MaxShortIndexCapacity
+			 * element switches to 32-bit indices. On OpenGL ES 2 without OES_element_index_uint
+			 * capacity is limited to MaxShortIndexCapacity, vertices over it are not rendered
+			 */
 			enum : uint32_t
 			{
-				MaxCapacity = 65536,
+				DefaultCapacity = 4096,
+				MaxShortIndexCapacity = 65536,
+			};
+			
+			/*
+			 * Vertices are always laid out as quads (QuadGeometry_Vertices per quad),
+			 * indexed with static pattern from shared index buffer.
+			 *
+			 * TripleBuffer - cycles three full-size buffers, each rebuild maps and invalidates whole buffer
+			 * RingBuffer - single buffer, each rebuild appends only written vertices after previous data
+			 *   without synchronization, when the end is reached whole storage is orphaned
+			 * Persistent - each vertex list owns stable range of the buffer, only changed ranges are uploaded.
+			 *   Ranges are rewritten with synchronized maps, so GL orders them after earlier draws
+			 */
+			enum class StreamingMode : uint32_t
+			{
+				TripleBuffer,
+				RingBuffer,
+				Persistent,
+			};
+			
+			/*
+			 * Default - SceneVertex as is (44 bytes per vertex)
+			 * Packed - PackedSceneVertex (28 bytes per vertex), unpacked in vertex shader
+			 * Instanced - SceneQuadInstance (64 bytes per quad), each quad is drawn as instance
+			 *   of the shared unit quad and restored in vertex shader, see packSceneQuad for limitations.
+			 *   Requires instancing and gl_VertexID (desktop GL 3.3 or GLES 3)
+			 */
+			enum class VertexFormat : uint32_t
+			{
+				Default,
+				Packed,
+				Instanced,
+			};
+			
+			struct VertexRange
+			{
+				size_t first = 0;
+				size_t count = 0;
+				
+				VertexRange(size_t f, size_t c) :
+					first(f), count(c) { }
 			};
 			
 		public:
-			RenderingElement(RenderContext* rc, size_t capacity);
+			/*
+			 * Render context could be null if backend is provided
+			 */
+			RenderingElement(RenderContext* rc, size_t capacity, StreamingMode mode = StreamingMode::TripleBuffer,
+				VertexFormat format = VertexFormat::Default, const RenderBackend::Pointer& backend = RenderBackend::Pointer());
 			~RenderingElement();
 			
 			void startAllocatingVertices();
-			SceneVertex* allocateVertices(size_t);
-			void commitAllocatedVertices();
+			
+			/*
+			 * Vertices are added in two steps: range is allocated first,
+			 * then vertices are written with object parameters slot assigned by renderer.
+			 * Vertex list identifies persistent range, written vertices could come from
+			 * another (transient) source, like CPU-clipped copy of the list
+			 */
+			VertexRange allocateVertices(const SceneVertexList&, size_t count, const Element2d* owner,
+				bool transient);
+			void writeVertices(const SceneVertexList&, const SceneVertexList& source, const VertexRange&,
+				size_t objectSlot);
+			
+			/*
+			 * Returns false if storage ran out of space, vertices should be added again
+			 * from scratch in this case, storage grows on next startAllocatingVertices
+			 */
+			bool commitAllocatedVertices();
 			
 			void clear();
 
 			const VertexArrayObject& vertexArrayObject();
+			
+			StreamingMode streamingMode() const
+				{ return _streamingMode; }
+			
+			VertexFormat vertexFormat() const
+				{ return _vertexFormat; }
+			
+			const RenderBackend::Pointer& backend() const
+				{ return _backend; }
+			
+			size_t capacity() const
+				{ return _capacity; }
+			
+			/*
+			 * Maximum amount of vertices requested within single build,
+			 * could be used to choose initial capacity
+			 */
+			size_t highWaterMark() const
+				{ return _highWaterMark; }
+			
+			/*
+			 * Amount of vertices uploaded to the GPU by the latest commit
+			 */
+			size_t uploadedVertices() const
+				{ return _uploadedVertices; }
+			
+			size_t baseVertex() const
+				{ return _baseVertex; }
+			
+			size_t baseIndex() const
+				{ return indexForVertex(_baseVertex); }
+			
+			static size_t indexForVertex(size_t vertex)
+				{ return QuadGeometry_Indices * (vertex / QuadGeometry_Vertices); }
 
 		private:
 			friend class SceneRenderer;
-			enum : uint32_t { VertexBuffersCount = 3 };
 			
-			union
+			enum : uint32_t
+			{
+				VertexBuffersCount = 3,
+			};
+			
+			struct DamageRecord
 			{
-				void* vertexData = nullptr;
-				SceneVertex* mappedVertices;
+				rect bounds;
+				size_t version = 0;
+				size_t buildIndex = 0;
 			};
 			
-			RenderState& renderState;
+			struct PersistentRange
+			{
+				const Element2d* owner = nullptr;
+				size_t version = 0;
+				size_t first = 0;
+				size_t count = 0;
+				size_t capacity = 0;
+				size_t buildIndex = 0;
+				size_t objectSlot = 0;
+				bool valid = false;
+				bool transient = false;
+			};
+			
+			void createBuffers(size_t capacity);
+			void enableInstancing(const VertexArrayObject&);
+			
+			/*
+			 * Base instance is not available in GL 3.3 and GLES 3,
+			 * so instance attributes are pointed to the first drawn instance instead
+			 */
+			void setFirstInstance(size_t);
+			void growIfNeeded();
+			
+			void copyVertices(const SceneVertexList&, size_t first, size_t count, size_t objectSlot);
+			
+			void commitToRingBuffer();
+			
+			VertexRange allocatePersistentVertices(const SceneVertexList&, size_t count, const Element2d* owner,
+				bool transient);
+			void writePersistentVertices(const SceneVertexList&, const SceneVertexList& source, size_t objectSlot);
+			bool commitPersistentVertices();
+			
+			void* vertexData = nullptr;
+			
+			RenderContext* _rc = nullptr;
+			RenderState* renderState = nullptr;
+			RenderBackend::Pointer _backend;
 			std::vector<RenderChunk, SharedBlockAllocatorSTDProxy<RenderChunk>> chunks;
 			VertexArrayObject vertices[VertexBuffersCount];
 			size_t allocatedVertices = 0;
 			size_t dataSize = 0;
 			size_t currentBufferIndex = 0;
+			
+			StreamingMode _streamingMode = StreamingMode::TripleBuffer;
+			VertexFormat _vertexFormat = VertexFormat::Default;
+			BinaryDataStorage _stagingData;
+			size_t _capacity = 0;
+			size_t _maxCapacity = 0;
+			size_t _requestedVertices = 0;
+			size_t _reservedVertices = 0;
+			size_t _highWaterMark = 0;
+			size_t _uploadedVertices = 0;
+			size_t _vertexSize = 0;
+			size_t _baseVertex = 0;
+			size_t _committedVertices = 0;
+			size_t _ringWriteOffset = 0;
+			
+			std::unordered_map<const SceneVertexList*, PersistentRange> _persistentRanges;
+			std::vector<VertexRange> _dirtyRanges;
+			size_t _persistentEnd = 0;
+			size_t _persistentLiveVertices = 0;
+			size_t _buildIndex = 0;
+			bool _overflow = false;
+			bool _maxCapacityReported = false;
+			
+			std::unordered_map<const SceneVertexList*, DamageRecord> _damageRecords;
+			size_t _damageBuildIndex = 0;
 		};
 	}
 }
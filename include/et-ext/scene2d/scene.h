@@ -23,6 +23,8 @@
 #include <et-ext/scene2d/slider.h>
 #include <et-ext/scene2d/table.h>
 #include <et-ext/scene2d/line.h>
+#include <et-ext/scene2d/chart.h>
+#include <et-ext/scene2d/cachedlayer.h>
 
 namespace et
 {
@@ -36,8 +38,48 @@ namespace et
 		public:
 			Scene(RenderContext* rc);
 			
+			/*
+			 * Headless scene, does not require render context and passes all rendering to the backend.
+			 * Render should be called with null render context, cached layers and elements
+			 * requiring pre-rendering are not rendered
+			 */
+			Scene(const vec2& size, const RenderBackend::Pointer&);
+			
 			void layout(const vec2& size, float duration = 0.0);
 			void render(RenderContext* rc);
+			
+			/*
+			 * In render-on-demand mode render does nothing while scene is idle:
+			 * nothing is invalidated, animating, transitioning or pre-rendering invalid content.
+			 * With retained rendering the last frame is presented from retained target,
+			 * otherwise application should check needsRendering before render and skip
+			 * clearing and presenting frame, or the frame would stay blank.
+			 */
+			void setRenderOnDemand(bool);
+			
+			bool renderOnDemand() const
+				{ return _renderOnDemand; }
+			
+			bool needsRendering();
+			
+			/*
+			 * Forces next frame to be rendered, for changes scene could not track
+			 */
+			void setNeedsRendering()
+				{ _renderRequested = true; }
+			
+			/*
+			 * Retained rendering keeps scene in persistent color target, redraws only
+			 * damaged regions of it and copies it to the bound framebuffer each frame.
+			 * Not supported with render backend.
+			 */
+			void setRetainedRendering(bool);
+			
+			bool retainedRendering() const
+				{ return _retainedRendering; }
+			
+			void setRetainedClearColor(const vec4& color)
+				{ _retainedClearColor = color; }
 
 			SceneRenderer& renderer() 
 				{ return _renderer; }
@@ -88,6 +130,28 @@ namespace et
 
 			void removeAllLayouts();
 			
+			/*
+			 * Render statistics of the latest frame, collected when enabled
+			 */
+			void setStatisticsEnabled(bool);
+			
+			const RenderStatistics& frameStatistics() const
+				{ return _frameStatistics; }
+			
+			RenderStatistics layoutStatistics(Layout::Pointer);
+			
+			Dictionary statisticsDictionary() const;
+			std::string statisticsJSON() const;
+			
+			/*
+			 * Render backend should be set before layouts are added. It replaces vertex uploads
+			 * and draw calls only, scene created with render context still compiles programs
+			 */
+			void setRenderBackend(const RenderBackend::Pointer&);
+			
+			const RenderBackend::Pointer& renderBackend() const
+				{ return _renderer.renderBackend(); }
+			
 			ET_DECLARE_EVENT1(layoutDidAppear, Layout::Pointer)
 			ET_DECLARE_EVENT1(layoutDidDisappear, Layout::Pointer)
 			ET_DECLARE_EVENT1(layoutWillAppear, Layout::Pointer)
@@ -105,11 +169,20 @@ namespace et
 					oldLayout(o), newLayout(n) { }
 			};
 
+			void init(const vec2& size);
+			
 			void buildLayoutVertices(RenderContext* rc, RenderingElement::Pointer element,
 				Layout::Pointer layout);
 			
 			void buildBackgroundVertices(RenderContext* rc);
 			void buildOverlayVertices(RenderContext* rc);
+			void buildElementVertices(RenderContext* rc, RenderingElement::Pointer& element, Element2d& source);
+			void collectStatistics(RenderStatistics*);
+			void updatePreRenderRegistry();
+			void renderRetained(RenderContext* rc, bool fullDamage);
+			void presentRetainedFramebuffer(RenderContext* rc);
+			bool validateRetainedFramebuffer(RenderContext* rc);
+			bool visibleLayoutsChanged();
 
 			void onKeyboardNeeded(Layout* l, Element2d* e);
 			void onKeyboardResigned(Layout* l);
@@ -163,6 +236,7 @@ namespace et
 				Vector3Animator animator;
 				vec3 offsetAlpha;
 				State state;
+				RenderStatistics statistics;
 			};
 			
 			typedef std::list<LayoutEntry::Pointer> LayoutEntryList;
@@ -178,11 +252,27 @@ namespace et
 			ImageView _overlay;
 			
 			Element2d::Pointer _keyboardFocusedElement;
-			Element2d::List _prerenderElements;
+			std::vector<Element2d*> _preRenderRegistry;
+			std::vector<Layout*> _preRenderRegistryLayouts;
+			std::vector<Element2d*> _prerenderElements;
+			std::vector<Element2d*> _cachedLayers;
+			size_t _preRenderRegistryHierarchyVersion = 0;
+			size_t _preRenderRegistryFlagsVersion = 0;
 
 			LayoutEntryList _layouts;
 			Layout::Pointer _topLayout;
 			vec2 _screenSize;
+			
+			RenderStatistics _frameStatistics;
+			
+			Framebuffer::Pointer _retainedFramebuffer;
+			std::vector<Layout*> _retainedVisibleLayouts;
+			vec4 _retainedClearColor = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			size_t _retainedHierarchyVersion = 0;
+			
+			bool _renderOnDemand = false;
+			bool _renderRequested = true;
+			bool _retainedRendering = false;
 		};
 
 	}
@@ -7,12 +7,15 @@
 
 #pragma once
 
+#include <map>
 #include <stack>
+#include <unordered_map>
 #include <et/core/objectscache.h>
 #include <et/core/containers.h>
 #include <et/camera/camera.h>
 #include <et-ext/scene2d/renderingelement.h>
 #include <et-ext/scene2d/vertexbuilder.h>
+#include <et-ext/scene2d/vertexbuildpool.h>
 
 namespace et
 {
@@ -24,8 +27,25 @@ namespace et
 			static const std::string defaultProgramName;
 			static const std::string defaultTextProgramName;
 			
+			/*
+			 * Scissor - each clip rect is applied with scissor test, chunks are split on clip changes
+			 * CPU - quads are clipped against clip rect when added, quads outside of it are dropped,
+			 * chunks are merged across clip rects. Rotated quads crossing clip edge fall back to scissor
+			 */
+			enum class ClippingMode : uint32_t
+			{
+				Scissor,
+				CPU,
+			};
+			
 		public:
 			SceneRenderer(RenderContext* rc);
+			
+			/*
+			 * Without render context programs are not compiled and default texture is not created,
+			 * such renderer could be used only with render backend
+			 */
+			SceneRenderer(RenderContext* rc, const vec2& windowSize);
 
 			void beginRender(RenderContext* rc);
 			void render(RenderContext* rc);
@@ -34,12 +54,107 @@ namespace et
 			void resetClipRect();
 			void pushClipRect(const recti&);
 			void popClipRect();
+			bool clipRectVisible(const recti&) const;
+			
+			/*
+			 * Clipping mode should be set before layouts are built
+			 */
+			void setClippingMode(ClippingMode mode)
+				{ _clippingMode = mode; }
+			
+			ClippingMode clippingMode() const
+				{ return _clippingMode; }
+			
+			/*
+			 * Statistics are collected only when enabled,
+			 * accumulated values are reset by resetStatistics
+			 */
+			void setStatisticsEnabled(bool enabled)
+				{ _statisticsEnabled = enabled; }
+			
+			bool statisticsEnabled() const
+				{ return _statisticsEnabled; }
+			
+			RenderStatistics& statistics()
+				{ return _statistics; }
+			
+			const RenderStatistics& statistics() const
+				{ return _statistics; }
+			
+			void resetStatistics();
+			void finishStatisticsFrame();
+			
+			/*
+			 * With render backend set render state is not touched
+			 * and chunks are passed to the backend instead of being drawn
+			 */
+			void setRenderBackend(const RenderBackend::Pointer& backend)
+				{ _renderBackend = backend; }
+			
+			const RenderBackend::Pointer& renderBackend() const
+				{ return _renderBackend; }
+			
+			/*
+			 * With at least one thread layouts rebuild vertices of elements
+			 * supporting parallel build on the pool before adding them to render queue
+			 */
+			void setVertexBuildThreads(size_t threads);
+			
+			/*
+			 * With damage tracking renderer collects screen-space rect covering vertex lists
+			 * which were changed, added or removed since rendering element was built last time.
+			 * Chunks outside of damage are not drawn, others are scissored to it.
+			 * Layouts should be rebuilt after tracking is enabled, so chunks would get their bounds
+			 */
+			void setDamageTrackingEnabled(bool enabled)
+				{ _damageTrackingEnabled = enabled; }
+			
+			bool damageTrackingEnabled() const
+				{ return _damageTrackingEnabled; }
+			
+			void resetDamage();
+			void addDamage(const rect&);
+			void addFullDamage();
+			
+			bool hasDamage() const
+				{ return (_damage.width > 0.0f) && (_damage.height > 0.0f); }
+			
+			const rect& damage() const
+				{ return _damage; }
+			
+			recti damageInWindowSpace() const;
+			
+			/*
+			 * Should wrap building of current rendering element,
+			 * vertex lists which were not added again are considered removed
+			 */
+			void startTrackingDamage();
+			void finishTrackingDamage();
+			
+			/*
+			 * Dynamic objects could change without rebuilding, so their chunks are always damaged
+			 */
+			void addDynamicChunksDamage();
+			
+			const VertexBuildPool::Pointer& vertexBuildPool() const
+				{ return _vertexBuildPool; }
 
 			void setProjectionMatrices(const vec2& contextSize);
+			
+			/*
+			 * Size of the window, clip rects and layout offsets are calculated in
+			 */
+			void setWindowSize(const vec2& size)
+				{ _windowSize = size; }
+			
+			const vec2& windowSize() const
+				{ return _windowSize; }
 			void setRendernigElement(const RenderingElement::Pointer& r);
+			
+			const RenderingElement::Pointer& renderingElement() const
+				{ return _renderingElement; }
 
-			void addVertices(const SceneVertexList&, const Texture::Pointer&, const SceneProgram&, Element2d*,
-				PrimitiveType = PrimitiveType::Triangles);
+			void addVertices(const SceneVertexList&, const Texture::Pointer&, const SceneProgram&, Element2d*);
 			
 			void setAdditionalOffsetAndAlpha(const vec3& offsetAndAlpha);
 						
@@ -58,30 +173,88 @@ namespace et
 			SceneProgram createProgramWithShaders(const std::string& name, const std::string& vs,
 				const std::string& fs);
 
+		private:
+			struct ProgramSource
+			{
+				std::string name;
+				std::string vertexShader;
+				std::string fragmentShader;
+			};
+			
+			struct ElementRecord
+			{
+				size_t version = 0;
+				size_t frame = 0;
+			};
+			
+			enum : uint32_t
+			{
+				ElementRecordLifetime = 600,
+			};
+			
 		private:
 			void init(RenderContext* rc);
 			
-			SceneVertex* allocateVertices(size_t, const Texture::Pointer&, const SceneProgram&, Element2d*, PrimitiveType);
+			size_t allocateVertices(const RenderingElement::VertexRange&, const recti& clip,
+				const Texture::Pointer&, const SceneProgram&, Element2d*, const rect& bounds);
+			
+			rect clipRectInVertexSpace(const recti&) const;
+			void trackElementVersion(const Element2d*);
+			rect trackVerticesDamage(const SceneVertexList&, const recti& clip, const Element2d*);
+			
+			void setObjectParameters(const RenderChunk&);
+			void gatherObjectParameters(const RenderChunk&);
+			
+			void renderChunks(RenderContext*, const IndexBuffer::Pointer&, size_t baseIndex);
+			void drawInstances(RenderContext*, const IndexBuffer::Pointer&, const RenderChunk&, size_t baseIndex);
+			void renderToBackend(const RenderBackend::Pointer&, size_t baseIndex);
+			void collectChunkStatistics();
+			
+			SceneProgram createProgram(const std::string& name, const std::string& vs, const std::string& fs);
+			const SceneProgram& programForVertexFormat(const SceneProgram&, RenderingElement::VertexFormat);
 
 			ET_DENY_COPY(SceneRenderer)
 			
 		private:
 			RenderContext* _rc;
 			RenderingElement::Pointer _renderingElement;
+			RenderBackend::Pointer _renderBackend;
+			VertexBuildPool::Pointer _vertexBuildPool;
 			
 			Texture::Pointer _lastTexture;
 			Texture::Pointer _defaultTexture;
 			
 			ObjectsCache _programsCache;
+			std::map<std::string, uint32_t> _programIdentifiers;
+			std::map<uint32_t, ProgramSource> _programSources;
+			std::map<uint32_t, SceneProgram> _packedPrograms;
+			std::map<uint32_t, SceneProgram> _instancedPrograms;
 			
 			SceneProgram _defaultProgram;
 			SceneProgram _defaultTextProgram;
 			SceneProgram _lastProgram;
 					
 			mat4 _defaultTransform;
+			vec4 _objectParameters[ObjectParameters_MaxObjects];
 			
 			std::stack<recti> _clip;
+			recti _screenClip;
+			SceneVertexList _clippedVertices;
+			ClippingMode _clippingMode = ClippingMode::Scissor;
+			
+			RenderStatistics _statistics;
+			std::unordered_map<const Element2d*, ElementRecord> _elementRecords;
+			size_t _statisticsFrame = 1;
+			bool _statisticsEnabled = false;
+			
+			rect _damage = rect(0.0f, 0.0f, 0.0f, 0.0f);
+			recti _damageWindowRect;
+			size_t _skippedChunks = 0;
+			size_t _submittedVertices = 0;
+			bool _fullDamage = false;
+			bool _damageTrackingEnabled = false;
 			
+			vec2 _windowSize;
 			vec3 _additionalOffsetAndAlpha;
 			recti _additionalWindowOffset;
 			recti _latestClipRect;
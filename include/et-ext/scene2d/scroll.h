@@ -80,8 +80,8 @@ namespace et
 			void addToRenderQueue(RenderContext*, SceneRenderer&);
 			void addToOverlayRenderQueue(RenderContext*, SceneRenderer&);
 			
-			const mat4& finalTransform();
-			const mat4& finalInverseTransform();
+			const Transform2d& finalTransform();
+			const Transform2d& finalInverseTransform();
 			
 			bool containsPoint(const vec2& p, const vec2& np);
 			
@@ -99,6 +99,13 @@ namespace et
 
 			void updateBouncing(float deltaTime);
 			
+			/*
+			 * Per-frame updates are suspended when scroll has settled
+			 * and resumed on interaction or content changes
+			 */
+			void resumeUpdates();
+			bool settled();
+			
 			bool horizontalBounce() const
 				{ return (_bounce & Bounce_Horizontal) != 0; }
 			
@@ -128,8 +135,8 @@ namespace et
 			PointerInputInfo _currentPointer;
 			PointerInputInfo _previousPointer;
 			
-			mat4 _localFinalTransform = mat4(1.0f);
-			mat4 _localInverseTransform = mat4(1.0f);
+			Transform2d _localFinalTransform;
+			Transform2d _localInverseTransform;
 			vec4 _backgroundColor = vec4(0.0f);
 			vec4 _scrollbarsColor = vec4(0.0f);
 			vec4 _overlayColor = vec4(0.0f);
@@ -147,6 +154,7 @@ namespace et
 
 			bool _pointerCaptured = false;
 			bool _manualScrolling = false;
+			bool _updating = false;
 			bool _floorOffset = false;
 		};
 
@@ -59,7 +59,7 @@ namespace et
 			
 		protected:
 			void processMessage(const Message&) override;
-			void setProgramParameters(et::RenderContext*, et::Program::Pointer&) override;
+			vec4 objectParameters() override;
 			
 			virtual void invalidateText() { }
 			
@@ -68,7 +68,6 @@ namespace et
 		private:
 			Font::Pointer _font;
 			SceneProgram _textProgram;
-			Program::Uniform _shadowUniform;
 			vec2 _shadowOffset;
 			float _fontSize = 12.0f;
 			float _fontSmoothing = 1.0f;
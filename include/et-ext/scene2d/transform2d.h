@@ -0,0 +1,84 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <et/geometry/geometry.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Planar affine transform stored as 3x2 matrix, follows mat4 conventions:
+		 * rows are transformed axes and translation, a * b applies a first
+		 */
+		struct Transform2d
+		{
+		public:
+			vec2 xAxis = vec2(1.0f, 0.0f);
+			vec2 yAxis = vec2(0.0f, 1.0f);
+			vec2 translation = vec2(0.0f);
+
+		public:
+			Transform2d()
+				{ }
+
+			Transform2d(const vec2& x, const vec2& y, const vec2& t) :
+				xAxis(x), yAxis(y), translation(t) { }
+
+			explicit Transform2d(const mat4& m) :
+				xAxis(m[0].x, m[0].y), yAxis(m[1].x, m[1].y), translation(m[3].x, m[3].y) { }
+
+			vec2 operator * (const vec2& p) const
+			{
+				return vec2(xAxis.x * p.x + yAxis.x * p.y + translation.x,
+					xAxis.y * p.x + yAxis.y * p.y + translation.y);
+			}
+
+			vec3 operator * (const vec3& p) const
+				{ return vec3(*this * p.xy(), p.z); }
+
+			Transform2d operator * (const Transform2d& t) const
+				{ return Transform2d(t.transformVector(xAxis), t.transformVector(yAxis), t * translation); }
+
+			vec2 transformVector(const vec2& v) const
+				{ return vec2(xAxis.x * v.x + yAxis.x * v.y, xAxis.y * v.x + yAxis.y * v.y); }
+
+			Transform2d inverse() const
+			{
+				float det = xAxis.x * yAxis.y - xAxis.y * yAxis.x;
+				if (std::abs(det) <= std::numeric_limits<float>::epsilon())
+					return Transform2d();
+
+				float invDet = 1.0f / det;
+				vec2 ix(yAxis.y * invDet, -xAxis.y * invDet);
+				vec2 iy(-yAxis.x * invDet, xAxis.x * invDet);
+				vec2 it(-(translation.x * ix.x + translation.y * iy.x), -(translation.x * ix.y + translation.y * iy.y));
+				return Transform2d(ix, iy, it);
+			}
+
+			mat4 toMatrix() const
+			{
+				mat4 result(1.0f);
+				result[0].x = xAxis.x;
+				result[0].y = xAxis.y;
+				result[1].x = yAxis.x;
+				result[1].y = yAxis.y;
+				result[3].x = translation.x;
+				result[3].y = translation.y;
+				return result;
+			}
+
+			static Transform2d translationTransform(const vec2& t)
+				{ return Transform2d(vec2(1.0f, 0.0f), vec2(0.0f, 1.0f), t); }
+		};
+
+		inline vec2 multiplyWithoutTranslation(const vec2& v, const Transform2d& t)
+			{ return t.transformVector(v); }
+	}
+}
@@ -14,21 +14,82 @@ namespace et
 {
 	namespace s2d
 	{
+		enum ClipResult
+		{
+			ClipResult_Inside,
+			ClipResult_Clipped,
+			ClipResult_Culled,
+			ClipResult_RequiresScissor,
+		};
+		
 		size_t measuseVertexCountForImageDescriptor(const ImageDescriptor& desc);
 		
+		void packSceneVertex(const SceneVertex& source, PackedSceneVertex& target);
+		
+		/*
+		 * Quad is restored as parallelogram built on the first, second and fourth vertices,
+		 * texCoords as rect between the first and the third ones,
+		 * colors and texCoord.zw of the other vertices should match the first or the third one
+		 */
+		void packSceneQuad(const SceneVertex* quad, SceneQuadInstance& target);
+		
 		void buildQuad(SceneVertexList& vertices, const SceneVertex& topLeft, const SceneVertex& topRight,
 			const SceneVertex& bottomLeft, const SceneVertex& bottomRight);
 		
 		void buildQuad(SceneVertexList& vertices, SceneVertex topLeft, SceneVertex topRight,
-			SceneVertex bottomLeft, SceneVertex bottomRight, const mat4& t);
+			SceneVertex bottomLeft, SceneVertex bottomRight, const Transform2d& t);
 		
 		void buildStringVertices(SceneVertexList& vertices, const CharDescriptorList& chars,  Alignment hAlign,
-			Alignment vAlign, const vec2& pos, const vec4& color, const mat4& transform, float lineInterval = 1.0f);
+			Alignment vAlign, const vec2& pos, const vec4& color, const Transform2d& transform, float lineInterval = 1.0f);
 
 		void buildImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex, const ImageDescriptor& desc,
-			const rect& p, const vec4& color, const mat4& transform);
+			const rect& p, const vec4& color, const Transform2d& transform);
 
 		void buildColorVertices(SceneVertexList& vertices, const rect& p, const vec4& color,
-			const mat4& transform);
+			const Transform2d& transform);
+		
+		/*
+		 * Builds single quad for nine-slice image, texCoord.xy maps quad to the texture starting
+		 * from the image origin and texCoord.zw - ending at the image end, both without scaling.
+		 * Slices are resolved in fragment shader using center part from nineSliceParameters
+		 */
+		void buildNineSliceImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex,
+			const ImageDescriptor& desc, const rect& p, const vec4& color, const Transform2d& transform);
+		
+		/*
+		 * texCoords of top left and bottom right corners of the center part
+		 */
+		vec4 nineSliceParameters(const Texture::Pointer& tex, const ImageDescriptor& desc);
+		
+		/*
+		 * Builds single quad for tiled image, texCoord.xy is position in tiles, changing from zero to repeats,
+		 * texCoord.zw is half of texel. Tiles are wrapped in fragment shader within imageTexCoordRect
+		 */
+		void buildTiledImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex, const rect& p,
+			const vec2& repeats, const vec4& color, const Transform2d& transform);
+		
+		/*
+		 * texCoords of top left and bottom right corners of the image
+		 */
+		vec4 imageTexCoordRect(const Texture::Pointer& tex, const ImageDescriptor& desc);
+		
+		/*
+		 * Transforms positions of vertices starting from `first` in one pass,
+		 * builders emit vertices in local space and transform them at once
+		 */
+		void transformVertexPositions(SceneVertexList& vertices, size_t first, const Transform2d& transform,
+			bool snapToPixels = false);
+		
+		/*
+		 * Clips quads against axis-aligned rect, fully outside quads are dropped.
+		 * Target is filled only for ClipResult_Clipped, ClipResult_RequiresScissor is returned
+		 * when rotated quad intersects the rect edge and could not be clipped on CPU
+		 */
+		ClipResult clipQuads(const SceneVertexList& source, SceneVertexList& target, const rect& clip);
+		
+		/*
+		 * Axis-aligned bounds of vertex positions, empty rect for empty list
+		 */
+		rect verticesBounds(const SceneVertexList& vertices);
 	}
 }
@@ -0,0 +1,64 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <et-ext/scene2d/baseclasses.h>
+
+namespace et
+{
+	namespace s2d
+	{
+		/*
+		 * Fixed set of worker threads used to build element vertices in parallel
+		 */
+		class VertexBuildPool : public Shared
+		{
+		public:
+			ET_DECLARE_POINTER(VertexBuildPool)
+			
+			typedef std::function<void(size_t)> Job;
+			
+		public:
+			VertexBuildPool(size_t threads);
+			~VertexBuildPool();
+			
+			size_t threadsCount() const
+				{ return _threads.size(); }
+			
+			/*
+			 * Calls job for each index in [0, count) and returns when all of them are finished,
+			 * calling thread takes part in processing
+			 */
+			void run(size_t count, const Job& job);
+			
+		private:
+			void workerMain();
+			void processJobs(const Job& job, size_t count);
+			
+			ET_DENY_COPY(VertexBuildPool)
+			
+		private:
+			std::vector<std::thread> _threads;
+			std::mutex _mutex;
+			std::condition_variable _jobsAvailable;
+			std::condition_variable _jobsFinished;
+			std::atomic<size_t> _nextJob;
+			
+			const Job* _job = nullptr;
+			size_t _jobsCount = 0;
+			size_t _activeWorkers = 0;
+			size_t _generation = 0;
+			bool _running = true;
+		};
+	}
+}
@@ -0,0 +1,168 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/element2d.h>
+#include <et-ext/scene2d/animationsystem.h>
+
+using namespace et;
+using namespace et::s2d;
+
+void AnimationSystem::animate(Element2d* e, AnimatedPropery p, float& value, float to, float duration)
+	{ addAnimation(e, p, &value, vec4(value), vec4(to), 1, duration); }
+
+void AnimationSystem::animate(Element2d* e, AnimatedPropery p, vec2& value, const vec2& to, float duration)
+	{ addAnimation(e, p, &value.x, vec4(value.x, value.y, 0.0f, 0.0f), vec4(to.x, to.y, 0.0f, 0.0f), 2, duration); }
+
+void AnimationSystem::animate(Element2d* e, AnimatedPropery p, vec4& value, const vec4& to, float duration)
+	{ addAnimation(e, p, &value.x, value, to, 4, duration); }
+
+void AnimationSystem::addAnimation(Element2d* e, AnimatedPropery p, float* target, const vec4& from,
+	const vec4& to, size_t components, float duration)
+{
+	ET_ASSERT((p > AnimatedProperty_None) && (p < AnimatedProperty_max));
+	ET_ASSERT(duration > 0.0f);
+
+	size_t& slot = e->_animationSlots[p];
+	if (slot == 0)
+	{
+		if (_targets.empty())
+			startUpdates();
+
+		_from.emplace_back();
+		_delta.emplace_back();
+		_values.emplace_back();
+		_startTime.emplace_back();
+		_inverseDuration.emplace_back();
+		_progress.emplace_back();
+		_targets.emplace_back();
+		_components.emplace_back();
+		_elements.emplace_back(e);
+		_properties.emplace_back(p);
+		slot = _targets.size();
+	}
+
+	size_t index = slot - 1;
+	_from[index] = from;
+	_delta[index] = to - from;
+	_startTime[index] = actualTime();
+	_inverseDuration[index] = 1.0f / duration;
+	_targets[index] = target;
+	_components[index] = components;
+}
+
+void AnimationSystem::cancelAnimation(Element2d* e, AnimatedPropery p)
+{
+	if (e->_animationSlots[p] > 0)
+		removeAnimation(e->_animationSlots[p] - 1);
+}
+
+void AnimationSystem::cancelAnimations(Element2d* e)
+{
+	for (size_t p = AnimatedProperty_None + 1; p < AnimatedProperty_max; ++p)
+	{
+		if (e->_animationSlots[p] > 0)
+			removeAnimation(e->_animationSlots[p] - 1);
+	}
+
+	for (auto& f : _finishedAnimations)
+	{
+		if (f.element == e)
+			f.element = nullptr;
+	}
+}
+
+void AnimationSystem::removeAnimation(size_t index)
+{
+	_elements[index]->_animationSlots[_properties[index]] = 0;
+
+	size_t last = _targets.size() - 1;
+	if (index < last)
+	{
+		_from[index] = _from[last];
+		_delta[index] = _delta[last];
+		_values[index] = _values[last];
+		_startTime[index] = _startTime[last];
+		_inverseDuration[index] = _inverseDuration[last];
+		_progress[index] = _progress[last];
+		_targets[index] = _targets[last];
+		_components[index] = _components[last];
+		_elements[index] = _elements[last];
+		_properties[index] = _properties[last];
+		_elements[index]->_animationSlots[_properties[index]] = index + 1;
+	}
+
+	_from.pop_back();
+	_delta.pop_back();
+	_values.pop_back();
+	_startTime.pop_back();
+	_inverseDuration.pop_back();
+	_progress.pop_back();
+	_targets.pop_back();
+	_components.pop_back();
+	_elements.pop_back();
+	_properties.pop_back();
+
+	if (_targets.empty())
+		cancelUpdates();
+}
+
+void AnimationSystem::update(float t)
+{
+	size_t count = _targets.size();
+
+	for (size_t i = 0; i < count; ++i)
+		_progress[i] = clamp((t - _startTime[i]) * _inverseDuration[i], 0.0f, 1.0f);
+
+	for (size_t i = 0; i < count; ++i)
+		_values[i] = _from[i] + _delta[i] * _progress[i];
+
+	for (size_t i = 0; i < count; ++i)
+		etCopyMemory(_targets[i], &_values[i].x, _components[i] * sizeof(float));
+
+	/*
+	 * Collect flags of all animated properties first, so element is invalidated once
+	 */
+	for (size_t i = 0; i < count; ++i)
+	{
+		Element2d* e = _elements[i];
+		if (e->_pendingAnimatedProperties == 0)
+			_updatedElements.push_back(e);
+		e->_pendingAnimatedProperties |= 1 << _properties[i];
+	}
+
+	const size_t colorFlag = 1 << AnimatedProperty_Color;
+	for (Element2d* e : _updatedElements)
+	{
+		if (e->_pendingAnimatedProperties & ~colorFlag)
+			e->invalidateTransform();
+
+		e->invalidateContent();
+		e->_pendingAnimatedProperties = 0;
+	}
+	_updatedElements.clear();
+
+	/*
+	 * Finished animations are removed before events are invoked,
+	 * handlers are free to start new animations or to cancel existing ones
+	 */
+	for (size_t i = count; i > 0; --i)
+	{
+		if (_progress[i - 1] >= 1.0f)
+		{
+			_finishedAnimations.emplace_back(_elements[i - 1], _properties[i - 1]);
+			removeAnimation(i - 1);
+		}
+	}
+
+	for (size_t i = 0; i < _finishedAnimations.size(); ++i)
+	{
+		FinishedAnimation f = _finishedAnimations.at(i);
+		if (f.element != nullptr)
+			f.element->elementAnimationFinished.invoke(f.element, f.property);
+	}
+	_finishedAnimations.clear();
+}
@@ -66,14 +66,14 @@ void Button::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
 
 void Button::buildVertices(RenderContext* rc, SceneRenderer&)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	
 	vec2 frameSize = size();
 	
 	_imageSize = absv(_image[_state].descriptor.size);
 	
 	float contentGap = (_imageSize.x > 0.0f) && ((_currentTextSize.x > 0.0f) || (_nextTextSize.x > 0.0f)) ?
-		(5.0f * static_cast<float>(rc->screenScaleFactor())) : 0.0f;
+		(5.0f * ((rc != nullptr) ? static_cast<float>(rc->screenScaleFactor()) : 1.0f)) : 0.0f;
 	
 	if (_imageSize.dotSelf() > 0.0f)
 	{
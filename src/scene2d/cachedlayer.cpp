@@ -0,0 +1,291 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/cachedlayer.h>
+
+using namespace et;
+using namespace et::s2d;
+
+extern std::string et_scene2d_cached_layer_shader_fs;
+
+ET_DECLARE_SCENE_ELEMENT_CLASS(CachedLayer)
+
+CachedLayer::CachedLayer(Element2d* parent, const std::string& name) :
+	Element2d(parent, ET_S2D_PASS_NAME_TO_BASE_CLASS)
+{
+	setFlag(Flag_CachedLayer);
+	setFlag(Flag_HandlesChildEvents);
+}
+
+bool CachedLayer::layerValid() const
+{
+	return _layerValid;
+}
+
+void CachedLayer::subtreeHierarchyChanged()
+{
+	_layerValid = false;
+}
+
+void CachedLayer::setInvalid()
+{
+	/*
+	 * Latest stamp belongs to the layer itself when its own content or transform is invalidated,
+	 * those are applied to the quad only and do not require rendering children again
+	 */
+	if (ownInvalidationStamp() != Element2d::invalidationStamp())
+		_layerValid = false;
+
+	Element2d::setInvalid();
+}
+
+bool CachedLayer::renderLayer(RenderContext* rc, SceneRenderer& r)
+{
+	ET_ASSERT(r.renderBackend().invalid() && "Cached layers are not supported with render backend");
+
+	vec2i textureSize(static_cast<int>(std::ceil(size().x)), static_cast<int>(std::ceil(size().y)));
+	if ((textureSize.x <= 0) || (textureSize.y <= 0))
+		return false;
+
+	if (_framebuffer.invalid() || (_framebuffer->size() != textureSize))
+	{
+		_framebuffer = rc->framebufferFactory().createFramebuffer(textureSize, "s2d-cached-layer",
+			TextureFormat::RGBA, TextureFormat::RGBA, DataType::UnsignedChar, TextureFormat::Invalid);
+		_framebuffer->renderTarget(0)->setFiltration(rc, TextureFiltration::Linear, TextureFiltration::Linear);
+		_framebuffer->renderTarget(0)->setWrap(rc, TextureWrap::ClampToEdge, TextureWrap::ClampToEdge);
+		_layerValid = false;
+	}
+
+	if (layerValid())
+		return false;
+
+	if (_renderingElement.invalid())
+		_renderingElement = RenderingElement::Pointer::create(rc, RenderingElement::DefaultCapacity);
+
+	/*
+	 * Layer space is not a part of the screen, so it should not be tracked as damage
+	 */
+	bool damageTrackingEnabled = r.damageTrackingEnabled();
+	r.setDamageTrackingEnabled(false);
+	r.setProjectionMatrices(vec2(static_cast<float>(textureSize.x), static_cast<float>(textureSize.y)));
+	r.resetClipRect();
+	r.setRendernigElement(_renderingElement);
+
+	_renderingElement->startAllocatingVertices();
+	for (auto& c : children())
+		addChildToRenderQueue(c.ptr(), rc, r);
+
+	if (!_renderingElement->commitAllocatedVertices())
+	{
+		_renderingElement->startAllocatingVertices();
+		for (auto& c : children())
+			addChildToRenderQueue(c.ptr(), rc, r);
+		_renderingElement->commitAllocatedVertices();
+	}
+
+	auto& rs = rc->renderState();
+	auto currentBuffer = rs.boundFramebuffer();
+	auto viewportSize = rs.viewportSize();
+	vec4 clearColor = rs.clearColor();
+
+	rs.bindFramebuffer(_framebuffer);
+	rs.setClip(false, recti(vec2i(0), textureSize));
+	rs.setClearColor(vec4(0.0f));
+	rc->renderer()->clear(true, false);
+	rs.setClearColor(clearColor);
+
+	/*
+	 * Alpha is accumulated as for premultiplied colors,
+	 * so texture could be composited over anything later
+	 */
+	r.beginRender(rc);
+	rs.setSeparateBlend(true, BlendState::Default, BlendState::AlphaPremultiplied);
+	r.setAdditionalOffsetAndAlpha(vec3(0.0f, 0.0f, 1.0f));
+	r.render(rc);
+	r.endRender(rc);
+
+	rs.bindFramebuffer(currentBuffer);
+	rs.setViewportSize(viewportSize);
+	r.setDamageTrackingEnabled(damageTrackingEnabled);
+
+	/*
+	 * Own invalidation, so quad is rebuilt with new texture contents
+	 */
+	invalidateContent();
+
+	_layerValid = true;
+
+	return true;
+}
+
+void CachedLayer::addChildToRenderQueue(Element2d* element, RenderContext* rc, SceneRenderer& r)
+{
+	if (!element->visible()) return;
+
+	bool clipToBounds = element->hasFlag(Flag_ClipToBounds);
+
+	if (clipToBounds)
+	{
+		const Transform2d& parentTransform = element->parent()->finalTransform();
+
+		vec2 eSize = multiplyWithoutTranslation(element->size(), parentTransform);
+		vec2 eOrigin = parentTransform * element->origin();
+
+		recti clipRect(vec2i(static_cast<int>(eOrigin.x), _framebuffer->size().y - static_cast<int>(eOrigin.y + eSize.y)),
+			vec2i(static_cast<int>(eSize.x), static_cast<int>(eSize.y)));
+
+		if (!r.clipRectVisible(clipRect))
+			return;
+
+		r.pushClipRect(clipRect);
+	}
+
+	element->addToRenderQueue(rc, r);
+
+	/*
+	 * Nested layers render their children into own texture
+	 */
+	if (!element->hasFlag(Flag_CachedLayer))
+	{
+		for (auto& c : element->children())
+			addChildToRenderQueue(c.ptr(), rc, r);
+	}
+
+	element->addToOverlayRenderQueue(rc, r);
+
+	if (clipToBounds)
+		r.popClipRect();
+}
+
+SceneProgram CachedLayer::initProgram(SceneRenderer& r)
+{
+	if (program().invalid())
+		setDefaultProgram(r.createProgramWithFragmentshader("et-scene2d-cached-layer", et_scene2d_cached_layer_shader_fs, false));
+
+	return program();
+}
+
+void CachedLayer::addToRenderQueue(RenderContext*, SceneRenderer& r)
+{
+	if (_framebuffer.invalid()) return;
+
+	initProgram(r);
+
+	if (!contentValid() || !transformValid())
+		buildVertices();
+
+	if (_vertices.lastElementIndex() > 0)
+		r.addVertices(_vertices, _framebuffer->renderTarget(0), program(), this);
+}
+
+void CachedLayer::buildVertices()
+{
+	_vertices.setOffset(0);
+
+	buildImageVertices(_vertices, _framebuffer->renderTarget(0), ImageDescriptor(vec2(0.0f), size()),
+		rect(vec2(0.0f), size()), finalColor(), Element2d::finalTransform());
+
+	setContentValid();
+}
+
+/*
+ * Children are placed in layer space, layer itself uses regular transforms
+ */
+const Transform2d& CachedLayer::finalTransform()
+{
+	return _childrenTransform;
+}
+
+const Transform2d& CachedLayer::finalInverseTransform()
+{
+	_localInverseTransform = Element2d::finalTransform().inverse();
+	return _localInverseTransform;
+}
+
+Element2d* CachedLayer::getActiveElement(const vec2& p, Element2d* root)
+{
+	for (auto cI = root->children().rbegin(), cE = root->children().rend(); cI != cE; ++cI)
+	{
+		Element2d* el = cI->ptr();
+
+		if (!el->visible() || !el->enabled() || !el->containsPoint(p, p))
+			continue;
+
+		if (el->hasFlag(Flag_HandlesChildEvents))
+			return el;
+
+		Element2d* child = getActiveElement(p, el);
+		if (child != nullptr)
+			return child;
+
+		if (!el->hasFlag(Flag_TransparentForPointer))
+			return el;
+	}
+
+	return nullptr;
+}
+
+PointerInputInfo CachedLayer::pointerInElement(const PointerInputInfo& p, Element2d* e)
+{
+	return PointerInputInfo(p.type, e->positionInElement(p.pos), p.normalizedPos, p.scroll,
+		p.id, p.timestamp, p.origin);
+}
+
+bool CachedLayer::pointerPressed(const PointerInputInfo& p)
+{
+	_capturedElement.reset(getActiveElement(p.pos, this));
+
+	if (_capturedElement.invalid())
+		return !hasFlag(Flag_TransparentForPointer);
+
+	return _capturedElement->pointerPressed(pointerInElement(p, _capturedElement.ptr()));
+}
+
+bool CachedLayer::pointerMoved(const PointerInputInfo& p)
+{
+	Element2d* target = _capturedElement.valid() ? _capturedElement.ptr() : getActiveElement(p.pos, this);
+	return (target == nullptr) ? false : target->pointerMoved(pointerInElement(p, target));
+}
+
+bool CachedLayer::pointerReleased(const PointerInputInfo& p)
+{
+	Element2d* target = _capturedElement.valid() ? _capturedElement.ptr() : getActiveElement(p.pos, this);
+	bool processed = (target == nullptr) ? false : target->pointerReleased(pointerInElement(p, target));
+
+	_capturedElement.reset(nullptr);
+	return processed;
+}
+
+bool CachedLayer::pointerCancelled(const PointerInputInfo& p)
+{
+	bool processed = _capturedElement.valid() &&
+		_capturedElement->pointerCancelled(pointerInElement(p, _capturedElement.ptr()));
+
+	_capturedElement.reset(nullptr);
+	return processed;
+}
+
+bool CachedLayer::pointerScrolled(const PointerInputInfo& p)
+{
+	Element2d* target = getActiveElement(p.pos, this);
+	return (target == nullptr) ? false : target->pointerScrolled(pointerInElement(p, target));
+}
+
+/*
+ * Layer texture contains premultiplied colors
+ */
+std::string et_scene2d_cached_layer_shader_fs =
+	"uniform etLowp sampler2D inputTexture;"
+	"etFragmentIn etHighp vec2 texCoord;"
+	"etFragmentIn etLowp vec4 tintColor;"
+	"etFragmentIn etLowp vec4 additiveColor;"
+	"void main()"
+	"{"
+	"	etLowp vec4 layerColor = etTexture2D(inputTexture, texCoord);"
+	"	layerColor.xyz /= max(layerColor.w, 1.0 / 255.0);"
+	"	etFragmentOut = layerColor * tintColor + additiveColor;"
+	"}";
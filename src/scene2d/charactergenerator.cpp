@@ -30,9 +30,17 @@ CharacterGenerator::CharacterGenerator(RenderContext* rc, const std::string& fac
 	_fontFace = fileExists(face) ? getFileName(face) : face;
 	_fontBoldFace = fileExists(boldFace) ? getFileName(boldFace) : boldFace;
 	
-	_texture = rc->textureFactory().genTexture(TextureTarget::Texture_2D, TextureFormat::R,
-		vec2i(defaultTextureSize), TextureFormat::R, DataType::UnsignedChar,
-		BinaryDataStorage(defaultTextureSize * defaultTextureSize, 0), face + "font");
+	if (rc == nullptr)
+	{
+		_textureDataSize = vec2i(static_cast<int>(defaultTextureSize));
+		_textureData = BinaryDataStorage(defaultTextureSize * defaultTextureSize, 0);
+	}
+	else
+	{
+		_texture = rc->textureFactory().genTexture(TextureTarget::Texture_2D, TextureFormat::R,
+			vec2i(defaultTextureSize), TextureFormat::R, DataType::UnsignedChar,
+			BinaryDataStorage(defaultTextureSize * defaultTextureSize, 0), face + "font");
+	}
 	
 	_grid0.grid.resize(initialGridDimensions);
 	_grid1.grid.resize(initialGridDimensions);
@@ -111,8 +119,12 @@ CharDescriptor CharacterGenerator::generateCharacter(int value, CharacterFlags f
 				updateTexture(textureRect.origin(), downsampledSize, downsampled);
 				
 				result.contentRect = rect(vector2ToFloat(topLeftOffset - charactersRenderingExtent / 2), vector2ToFloat(sizeToSave));
-				result.uvRect = rect(_texture->getTexCoord(vector2ToFloat(textureRect.origin())),
-					vector2ToFloat(textureRect.size()) / _texture->sizeFloat());
+				vec2 textureSizeFloat = vector2ToFloat(textureSize());
+				vec2 placedOrigin = vector2ToFloat(textureRect.origin());
+				vec2 uvOrigin = _texture.valid() ? _texture->getTexCoord(placedOrigin) :
+					vec2(placedOrigin.x / textureSizeFloat.x, 1.0f - placedOrigin.y / textureSizeFloat.y);
+				
+				result.uvRect = rect(uvOrigin, vector2ToFloat(textureRect.size()) / textureSizeFloat);
 			}
 			else
 			{
@@ -134,8 +146,20 @@ CharDescriptor CharacterGenerator::generateCharacter(int value, CharacterFlags f
 
 void CharacterGenerator::updateTexture(const vec2i& position, const vec2i& size, BinaryDataStorage& data)
 {
-	vec2i dest(position.x, _texture->size().y - position.y - size.y - 1);
-	_texture->updatePartialDataDirectly(_rc, dest, size, data.binary(), data.dataSize());
+	vec2i target = textureSize();
+	vec2i dest(position.x, target.y - position.y - size.y - 1);
+	
+	if (_texture.valid())
+	{
+		_texture->updatePartialDataDirectly(_rc, dest, size, data.binary(), data.dataSize());
+		return;
+	}
+	
+	for (int y = etMax(0, -dest.y); (y < size.y) && (dest.y + y < target.y); ++y)
+	{
+		etCopyMemory(_textureData.binary() + (dest.y + y) * target.x + dest.x,
+			data.binary() + y * size.x, static_cast<size_t>(size.x));
+	}
 }
 
 void CharacterGenerator::setTexture(Texture::Pointer tex)
@@ -148,8 +172,9 @@ void CharacterGenerator::pushCharacter(const et::s2d::CharDescriptor& desc)
 	CharDescriptorMap& mapToInsert = ((desc.flags & CharacterFlag_Bold) == CharacterFlag_Bold) ? _boldChars : _chars;
 	mapToInsert.insert(std::make_pair(desc.value, desc));
 	
-	vec2 size = _texture->sizeFloat() * desc.uvRect.size();
-	vec2 origin = _texture->sizeFloat() * vec2(desc.uvRect.origin().x, 1.0f - desc.uvRect.origin().y);
+	vec2 textureSizeFloat = vector2ToFloat(textureSize());
+	vec2 size = textureSizeFloat * desc.uvRect.size();
+	vec2 origin = textureSizeFloat * vec2(desc.uvRect.origin().x, 1.0f - desc.uvRect.origin().y);
 	
 	_placer.addPlacedRect(recti(static_cast<int>(origin.x), static_cast<int>(origin.y),
 		static_cast<int>(size.x), static_cast<int>(size.y)));
@@ -0,0 +1,410 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/scenerenderer.h>
+#include <et-ext/scene2d/vertexbuilder.h>
+#include <et-ext/scene2d/chart.h>
+
+using namespace et;
+using namespace et::s2d;
+
+extern std::string et_scene2d_default_shader_fs;
+extern std::string et_scene2d_chart_shader_vs;
+
+static const size_t noDirtyColumns = std::numeric_limits<size_t>::max();
+
+ET_DECLARE_SCENE_ELEMENT_CLASS(Chart)
+
+Chart::Chart(Element2d* parent, const std::string& name) :
+	Element2d(parent, ET_S2D_PASS_NAME_TO_BASE_CLASS)
+{
+	setFlag(Flag_TransparentForPointer);
+	setFlag(Flag_HasObjectParameters);
+}
+
+size_t Chart::addSeries(const vec4& color, size_t capacity)
+{
+	ET_ASSERT(capacity > 0);
+
+	_series.emplace_back();
+
+	Series& s = _series.back();
+	s.samples.resize(capacity);
+	s.color = color;
+	s.dirtyColumn = noDirtyColumns;
+
+	if (_samplesPerColumn > 0)
+		s.columns.resize(capacity / _samplesPerColumn + 2);
+
+	invalidateContent();
+	return _series.size() - 1;
+}
+
+void Chart::clearSeries(size_t index)
+{
+	ET_ASSERT(index < _series.size());
+
+	Series& s = _series[index];
+	s.samplesCount = 0;
+	s.builtColumns = 0;
+	s.dirtyColumn = noDirtyColumns;
+	s.vertices.setOffset(0);
+
+	invalidateContent();
+}
+
+void Chart::setSeriesColor(size_t index, const vec4& color)
+{
+	ET_ASSERT(index < _series.size());
+
+	_series[index].color = color;
+	_layoutValid = false;
+	invalidateContent();
+}
+
+size_t Chart::samplesCount(size_t index) const
+{
+	ET_ASSERT(index < _series.size());
+	return _series[index].samplesCount;
+}
+
+void Chart::appendValue(size_t series, float value)
+{
+	appendValues(series, &value, 1);
+}
+
+void Chart::appendValues(size_t series, const float* values, size_t count)
+{
+	ET_ASSERT(series < _series.size());
+	if (count == 0) return;
+
+	Series& s = _series[series];
+	size_t capacity = s.samples.size();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		size_t index = s.samplesCount++;
+		s.samples[index % capacity] = values[i];
+
+		if (_samplesPerColumn > 0)
+			addSampleToColumn(s, index, values[i], (index % _samplesPerColumn) == 0);
+	}
+
+	if (_samplesPerColumn > 0)
+		s.dirtyColumn = etMin(s.dirtyColumn, (s.samplesCount - count) / _samplesPerColumn);
+
+	invalidateContent();
+}
+
+void Chart::setValueRange(float minValue, float maxValue)
+{
+	ET_ASSERT(maxValue > minValue);
+
+	_valueRange = vec2(minValue, maxValue);
+	_layoutValid = false;
+	invalidateContent();
+}
+
+void Chart::setLineWidth(float w)
+{
+	_lineWidth = w;
+	_layoutValid = false;
+	invalidateContent();
+}
+
+void Chart::setVisibleSamples(size_t samples)
+{
+	ET_ASSERT(samples > 0);
+
+	_visibleSamples = samples;
+	_layoutValid = false;
+	invalidateContent();
+}
+
+void Chart::setScrollOffset(size_t offset)
+{
+	_scrollOffset = offset;
+	invalidateContent();
+}
+
+vec4 Chart::objectParameters()
+{
+	return vec4(_columnAxis.x, _columnAxis.y, static_cast<float>(_ringHead),
+		static_cast<float>(etMax(size_t(1), _visibleColumns)));
+}
+
+size_t Chart::oldestSample(const Series& s) const
+{
+	return (s.samplesCount > s.samples.size()) ? s.samplesCount - s.samples.size() : 0;
+}
+
+float Chart::valueToPosition(float value) const
+{
+	float t = (clamp(value, _valueRange.x, _valueRange.y) - _valueRange.x) / (_valueRange.y - _valueRange.x);
+	return size().y * (1.0f - t);
+}
+
+void Chart::addSampleToColumn(Series& s, size_t index, float value, bool startsColumn)
+{
+	Column& c = s.columns[(index / _samplesPerColumn) % s.columns.size()];
+
+	if (startsColumn)
+	{
+		c.minValue = value;
+		c.maxValue = value;
+	}
+	else
+	{
+		c.minValue = etMin(c.minValue, value);
+		c.maxValue = etMax(c.maxValue, value);
+	}
+
+	c.lastValue = value;
+}
+
+/*
+ * Columns are aligned to absolute sample indices, so appended samples never change
+ * summaries of complete columns. Ring of columns is a bit larger than ring of samples,
+ * so partially overwritten columns at both ends do not overlap.
+ */
+void Chart::buildColumnSummaries(Series& s)
+{
+	size_t capacity = s.samples.size();
+	s.columns.resize(capacity / _samplesPerColumn + 2);
+
+	size_t first = oldestSample(s);
+	for (size_t i = first; i < s.samplesCount; ++i)
+		addSampleToColumn(s, i, s.samples[i % capacity], (i == first) || (i % _samplesPerColumn == 0));
+}
+
+void Chart::addToRenderQueue(RenderContext*, SceneRenderer& r)
+{
+	/*
+	 * Vertices are clipped on CPU before shift in vertex shader,
+	 * so in that mode slots should match visible positions of columns
+	 */
+	bool fixedSlots = (r.clippingMode() == SceneRenderer::ClippingMode::CPU);
+
+	if (!contentValid() || !transformValid() || (fixedSlots && (_ringHead != 0)))
+		buildVertices(fixedSlots);
+
+	const SceneProgram& prog = chartProgram(r);
+	for (const Series& s : _series)
+	{
+		if (s.vertices.lastElementIndex() > 0)
+			r.addVertices(s.vertices, Texture::Pointer(), prog, this);
+	}
+}
+
+const SceneProgram& Chart::chartProgram(SceneRenderer& r)
+{
+	if (_chartProgram.invalid())
+		_chartProgram = r.createProgramWithShaders("et-scene2d-chart", et_scene2d_chart_shader_vs, et_scene2d_default_shader_fs);
+
+	return _chartProgram;
+}
+
+/*
+ * Column is written to slot (column + phase of series) % visible columns, slot of the first
+ * visible column is shared by all series. When series scroll together, head follows them
+ * and columns keep their slots, so only columns changed by appended samples are rebuilt
+ */
+void Chart::buildVertices(bool fixedSlots)
+{
+	size_t pixelColumns = etMax(size_t(1), static_cast<size_t>(size().x));
+	size_t samplesPerColumn = (_visibleSamples + pixelColumns - 1) / pixelColumns;
+
+	if (samplesPerColumn != _samplesPerColumn)
+	{
+		_samplesPerColumn = samplesPerColumn;
+		for (Series& s : _series)
+			buildColumnSummaries(s);
+
+		_layoutValid = false;
+	}
+
+	vec4 color = finalColor();
+	size_t transformStamp = effectiveTransformStamp();
+
+	bool rebuild = !_layoutValid || (_builtTransformStamp != transformStamp) ||
+		(_builtSize != size()) || (_builtColor != color);
+
+	_visibleColumns = (_visibleSamples + _samplesPerColumn - 1) / _samplesPerColumn;
+	_columnWidth = size().x / static_cast<float>(_visibleColumns);
+
+	const Transform2d& transform = finalTransform();
+	_columnAxis = transform * vec2(_columnWidth, 0.0f) - transform * vec2(0.0f);
+
+	size_t head = 0;
+	if (!rebuild && !fixedSlots)
+	{
+		size_t firstColumn = 0;
+		size_t lastColumn = 0;
+		for (const Series& s : _series)
+		{
+			if ((s.builtColumns > 0) && visibleColumnsRange(s, firstColumn, lastColumn))
+			{
+				head = (s.ringPhase + firstColumn) % _visibleColumns;
+				break;
+			}
+		}
+	}
+	_ringHead = head;
+
+	for (Series& s : _series)
+		buildSeriesVertices(s, rebuild, color, transform);
+
+	_builtTransformStamp = transformStamp;
+	_builtSize = size();
+	_builtColor = color;
+	_layoutValid = true;
+
+	setContentValid();
+}
+
+bool Chart::visibleColumnsRange(const Series& s, size_t& firstColumn, size_t& lastColumn) const
+{
+	if ((s.samplesCount == 0) || (_samplesPerColumn == 0))
+		return false;
+
+	size_t lastSample = s.samplesCount - 1 - etMin(_scrollOffset, s.samplesCount - 1);
+	lastColumn = lastSample / _samplesPerColumn;
+	firstColumn = etMax(oldestSample(s) / _samplesPerColumn,
+		(lastColumn + 1 > _visibleColumns) ? lastColumn + 1 - _visibleColumns : 0);
+
+	return true;
+}
+
+void Chart::buildSeriesVertices(Series& s, bool rebuild, const vec4& color, const Transform2d& transform)
+{
+	size_t firstColumn = 0;
+	size_t lastColumn = 0;
+
+	if (!visibleColumnsRange(s, firstColumn, lastColumn) || (_columnWidth <= 0.0f))
+	{
+		s.vertices.setOffset(0);
+		s.builtColumns = 0;
+		return;
+	}
+
+	size_t phase = (_ringHead + _visibleColumns - firstColumn % _visibleColumns) % _visibleColumns;
+	size_t builtLastColumn = s.builtFirstColumn + s.builtColumns - 1;
+
+	/*
+	 * Built columns are still valid in their slots if phase is the same,
+	 * and either every slot is used by visible column or range only grows to the right
+	 */
+	bool incremental = !rebuild && (s.builtColumns > 0) && (s.ringPhase == phase) &&
+		((lastColumn + 1 - firstColumn == _visibleColumns) ||
+		((firstColumn == s.builtFirstColumn) && (lastColumn >= builtLastColumn)));
+
+	s.ringPhase = phase;
+	vec4 seriesColor = color * s.color;
+
+	if (incremental)
+	{
+		/*
+		 * First column is not connected to the previous one, so it changes when range is scrolled
+		 */
+		if (firstColumn != s.builtFirstColumn)
+			buildColumnVertices(s, firstColumn, firstColumn, seriesColor, transform);
+
+		for (size_t c = firstColumn, e = etMin(s.builtFirstColumn, lastColumn + 1); c < e; ++c)
+			buildColumnVertices(s, c, firstColumn, seriesColor, transform);
+
+		for (size_t c = etMax(firstColumn, etMin(s.dirtyColumn, builtLastColumn + 1)); c <= lastColumn; ++c)
+			buildColumnVertices(s, c, firstColumn, seriesColor, transform);
+	}
+	else
+	{
+		/*
+		 * Slots without visible columns are kept as degenerate quads
+		 */
+		SceneVertex empty(vec2(0.0f), vec4(0.0f), vec4(0.0f));
+		s.vertices.setOffset(0);
+		s.vertices.fitToSize(QuadGeometry_Vertices * _visibleColumns);
+		for (size_t i = 0; i < _visibleColumns; ++i)
+			buildQuad(s.vertices, empty, empty, empty, empty);
+
+		for (size_t c = firstColumn; c <= lastColumn; ++c)
+			buildColumnVertices(s, c, firstColumn, seriesColor, transform);
+	}
+
+	s.vertices.setOffset(QuadGeometry_Vertices * _visibleColumns);
+	s.builtFirstColumn = firstColumn;
+	s.builtColumns = lastColumn + 1 - firstColumn;
+	s.dirtyColumn = noDirtyColumns;
+}
+
+/*
+ * Column is built at position of its slot, texCoord.x keeps the slot for vertex shader
+ */
+void Chart::buildColumnVertices(Series& s, size_t c, size_t firstColumn, const vec4& color, const Transform2d& transform)
+{
+	size_t columnsCount = s.columns.size();
+	size_t slot = (c + s.ringPhase) % _visibleColumns;
+
+	const Column& column = s.columns[c % columnsCount];
+	bool hasPrevious = (c > firstColumn);
+	float previousValue = hasPrevious ? s.columns[(c - 1) % columnsCount].lastValue : column.lastValue;
+	float x0 = _columnWidth * static_cast<float>(slot);
+	float halfWidth = 0.5f * _lineWidth;
+	vec4 texCoord(static_cast<float>(slot), 0.0f, 0.0f, 1.0f);
+
+	s.vertices.setOffset(QuadGeometry_Vertices * slot);
+
+	if (_samplesPerColumn == 1)
+	{
+		/*
+		 * Column contains single sample, it is connected to the previous one with segment
+		 */
+		vec2 p2(x0 + 0.5f * _columnWidth, valueToPosition(column.lastValue));
+		vec2 p1(hasPrevious ? p2.x - _columnWidth : x0, valueToPosition(previousValue));
+		vec2 n = halfWidth * normalize(vec2(p2.y - p1.y, p1.x - p2.x));
+		buildQuad(s.vertices, SceneVertex(p1 - n, texCoord, color), SceneVertex(p1 + n, texCoord, color),
+			SceneVertex(p2 - n, texCoord, color), SceneVertex(p2 + n, texCoord, color), transform);
+	}
+	else
+	{
+		/*
+		 * Envelope of the column includes last value of the previous one, so columns are connected
+		 */
+		float top = valueToPosition(etMax(column.maxValue, previousValue)) - halfWidth;
+		float bottom = valueToPosition(etMin(column.minValue, previousValue)) + halfWidth;
+		float x1 = x0 + etMax(_columnWidth, _lineWidth);
+		buildQuad(s.vertices, SceneVertex(vec2(x0, top), texCoord, color),
+			SceneVertex(vec2(x1, top), texCoord, color), SceneVertex(vec2(x0, bottom), texCoord, color),
+			SceneVertex(vec2(x1, bottom), texCoord, color), transform);
+	}
+}
+
+/*
+ * Vertices are built in slots, TexCoord0.x is the slot, objectParameters.xy - column width,
+ * z - slot of the first visible column, w - amount of slots
+ */
+std::string et_scene2d_chart_shader_vs =
+"uniform mat4 mTransform;"
+"uniform vec3 additionalOffsetAndAlpha;"
+"uniform vec4 objectParameters[" + intToStr(ObjectParameters_MaxObjects) + "];"
+"etVertexIn vec3 Vertex;"
+"etVertexIn vec4 TexCoord0;"
+"etVertexIn vec4 Color;"
+"etVertexOut etHighp vec2 texCoord;"
+"etVertexOut etLowp vec4 tintColor;"
+"etVertexOut etLowp vec4 additiveColor;"
+"void main()"
+"{"
+"	vec4 ring = objectParameters[int(Vertex.z)];"
+"	float column = floor(mod(TexCoord0.x - ring.z + ring.w + 0.5, ring.w));"
+"	vec2 position = Vertex.xy + (column - TexCoord0.x) * ring.xy;"
+"	texCoord = vec2(0.0);"
+"	vec4 alphaScaledColor = Color * vec4(1.0, 1.0, 1.0, additionalOffsetAndAlpha.z);"
+"	additiveColor = alphaScaledColor * TexCoord0.w;"
+"	tintColor = alphaScaledColor * (1.0 - TexCoord0.w);"
+"	vec4 vTransformed = mTransform * vec4(position, 0.0, 1.0);"
+"	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
+"}";
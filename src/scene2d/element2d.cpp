@@ -5,6 +5,7 @@
  *
  */
 
+#include <typeindex>
 #include <et/core/conversion.h>
 #include <et/json/json.h>
 #include <et-ext/scene2d/scenerenderer.h>
@@ -13,65 +14,124 @@
 using namespace et;
 using namespace et::s2d;
 
+static std::map<std::type_index, std::string>& elementClassNames()
+{
+	static std::map<std::type_index, std::string> names;
+	return names;
+}
+
+const std::string& et::s2d::registerElementClassName(const std::type_info& type, const std::string& name)
+{
+	elementClassNames()[std::type_index(type)] = name;
+	return name;
+}
+
+std::string et::s2d::elementClassName(const std::type_info& type)
+{
+	auto i = elementClassNames().find(std::type_index(type));
+	return (i == elementClassNames().end()) ? std::string(type.name()) : i->second;
+}
+
 ET_DECLARE_SCENE_ELEMENT_CLASS(Element2d)
 
+AtomicCounter contentVersionCounter;
+
+/*
+ * Latest issued stamp, inherited stamps resolved at it are up to date
+ */
+static size_t latestInvalidationStamp = 0;
+static size_t invalidationPropagationGeneration = 1;
+static size_t hierarchyVersionValue = 0;
+static size_t flagsVersionValue = 0;
+static size_t transformVersionValue = 0;
+
+static size_t nextInvalidationStamp()
+{
+	latestInvalidationStamp = static_cast<size_t>(contentVersionCounter.retain());
+	return latestInvalidationStamp;
+}
+
 Element2d::Element2d(Element2d* parent, const std::string& name) :
-	ElementHierarchy(parent), _name(name), _positionAnimator(timerPool()),
-	_sizeAnimator(timerPool()), _colorAnimator(timerPool()), _scaleAnimator(timerPool()),
-	_angleAnimator(timerPool())
+	ElementHierarchy(parent), _name(name)
 {
-	initAnimators();
+	_contentVersion = nextInvalidationStamp();
+	_contentStamp = _contentVersion;
+	_transformStamp = _contentVersion;
+	hierarchyChanged();
 }
 
 Element2d::Element2d(const rect& frame, Element2d* parent, const std::string& name) :
-	ElementHierarchy(parent), _name(name), _positionAnimator(timerPool()),
-	_sizeAnimator(timerPool()), _colorAnimator(timerPool()), _scaleAnimator(timerPool()),
-	_angleAnimator(timerPool()), _layout(frame), _desiredLayout(frame)
+	ElementHierarchy(parent), _name(name), _layout(frame), _desiredLayout(frame)
 {
-	initAnimators();
+	_contentVersion = nextInvalidationStamp();
+	_contentStamp = _contentVersion;
+	_transformStamp = _contentVersion;
+	hierarchyChanged();
 }
 
-void Element2d::initAnimators()
+Element2d::~Element2d()
 {
-	_sizeAnimator.setTag(AnimatedProperty_Size);
-	_sizeAnimator.updated.connect(this, &Element2d::invalidateTransform);
-	_sizeAnimator.updated.connect(this, &Element2d::invalidateContent);
-	_sizeAnimator.finished.connect([this](){ elementAnimationFinished.invoke(this, AnimatedProperty_Size); });
-	
-	_colorAnimator.animate(vec4(1.0f), 0.0f);
-	_colorAnimator.setTag(AnimatedProperty_Color);
-	_colorAnimator.updated.connect([this]() { invalidateContent(); });
-	_colorAnimator.finished.connect([this](){ elementAnimationFinished.invoke(this, AnimatedProperty_Color); });
-	
-	_scaleAnimator.setTag(AnimatedProperty_Scale);
-	_scaleAnimator.updated.connect(this, &Element2d::invalidateTransform);
-	_scaleAnimator.updated.connect(this, &Element2d::invalidateContent);
-	_scaleAnimator.finished.connect([this](){ elementAnimationFinished.invoke(this, AnimatedProperty_Scale); });
-	
-	_angleAnimator.setTag(AnimatedProperty_Angle);
-	_angleAnimator.updated.connect(this, &Element2d::invalidateTransform);
-	_angleAnimator.updated.connect(this, &Element2d::invalidateContent);
-	_angleAnimator.finished.connect([this](){ elementAnimationFinished.invoke(this, AnimatedProperty_Angle); });
-	
-	_positionAnimator.setTag(AnimatedProperty_Position);
-	_positionAnimator.updated.connect(this, &Element2d::invalidateTransform);
-	_positionAnimator.updated.connect(this, &Element2d::invalidateContent);
-	_positionAnimator.finished.connect([this](){ elementAnimationFinished.invoke(this, AnimatedProperty_Position); });
+	AnimationSystem::instance().cancelAnimations(this);
+	++hierarchyVersionValue;
+}
+
+size_t Element2d::hierarchyVersion()
+	{ return hierarchyVersionValue; }
+
+/*
+ * Destroyed elements are not reported to layers, attached ones are removed from parent first
+ */
+void Element2d::hierarchyChanged()
+{
+	++hierarchyVersionValue;
+
+	for (Element2d* e = this; e != nullptr; e = e->parent())
+	{
+		if (e->hasFlag(Flag_CachedLayer))
+			e->subtreeHierarchyChanged();
+	}
+}
+
+size_t Element2d::invalidationStamp()
+	{ return latestInvalidationStamp; }
+
+size_t Element2d::flagsVersion()
+	{ return flagsVersionValue; }
+
+size_t Element2d::transformVersion()
+	{ return transformVersionValue; }
+
+void Element2d::setFlag(size_t flag)
+{
+	FlagsHolder::setFlag(flag);
+	++flagsVersionValue;
+}
+
+void Element2d::setFlags(size_t flags)
+{
+	FlagsHolder::setFlags(flags);
+	++flagsVersionValue;
+}
+
+void Element2d::removeFlag(size_t flag)
+{
+	FlagsHolder::removeFlag(flag);
+	++flagsVersionValue;
 }
 
 void Element2d::setAngle(float anAngle, float duration)
 {
-	_angleAnimator.cancelUpdates();
 	_desiredLayout.angle = anAngle;
 	
 	if (duration <= std::numeric_limits<float>::epsilon())
 	{
+		AnimationSystem::instance().cancelAnimation(this, AnimatedProperty_Angle);
 		_layout.angle = _desiredLayout.angle;
 		invalidateTransform();
 	}
 	else 
 	{
-		_angleAnimator.animate(&_layout.angle, _layout.angle, _desiredLayout.angle, duration);
+		AnimationSystem::instance().animate(this, AnimatedProperty_Angle, _layout.angle, _desiredLayout.angle, duration);
 	}
 }
 
@@ -86,46 +146,55 @@ void Element2d::setPivotPoint(const vec2& p, bool preservePosition)
 
 void Element2d::setScale(const vec2& aScale, float duration)
 {
-	_scaleAnimator.cancelUpdates();
 	_desiredLayout.scale = aScale;
 	
 	if (duration <= std::numeric_limits<float>::epsilon())
 	{
+		AnimationSystem::instance().cancelAnimation(this, AnimatedProperty_Scale);
 		_layout.scale = _desiredLayout.scale;
 		invalidateTransform();
 	}
 	else 
 	{
-		_scaleAnimator.animate(&_layout.scale, _layout.scale, _desiredLayout.scale, duration);
+		AnimationSystem::instance().animate(this, AnimatedProperty_Scale, _layout.scale, _desiredLayout.scale, duration);
 	}
 }
 
 void Element2d::setColor(const vec4& aColor, float duration)
 {
-	_colorAnimator.animate(aColor, duration);
+	if (duration <= std::numeric_limits<float>::epsilon())
+	{
+		AnimationSystem::instance().cancelAnimation(this, AnimatedProperty_Color);
+		_color = aColor;
+		invalidateContent();
+	}
+	else
+	{
+		AnimationSystem::instance().animate(this, AnimatedProperty_Color, _color, aColor, duration);
+	}
 }
 
 void Element2d::setAlpha(float alpha, float duration) 
 {
-	setColor(vec4(_colorAnimator.value().xyz(), alpha), duration);
+	setColor(vec4(_color.xyz(), alpha), duration);
 }
 
 void Element2d::setPosition(const vec2& p, float duration) 
 {
 	willChangeFrame();
 	
-	_positionAnimator.cancelUpdates();
 	_desiredLayout.position = p;
 	
 	if (duration <= std::numeric_limits<float>::epsilon())
 	{
+		AnimationSystem::instance().cancelAnimation(this, AnimatedProperty_Position);
 		_layout.position = _desiredLayout.position;
 		invalidateTransform();
 		invalidateContent();
 	}
 	else
 	{
-		_positionAnimator.animate(&_layout.position, _layout.position, _desiredLayout.position, duration);
+		AnimationSystem::instance().animate(this, AnimatedProperty_Position, _layout.position, _desiredLayout.position, duration);
 	}
 	
 	didChangeFrame();
@@ -135,18 +204,18 @@ void Element2d::setSize(const vec2& s, float duration)
 { 
 	willChangeFrame();
 	
-	_sizeAnimator.cancelUpdates();
 	_desiredLayout.size = s;
 	
 	if (duration <= std::numeric_limits<float>::epsilon())
 	{
+		AnimationSystem::instance().cancelAnimation(this, AnimatedProperty_Size);
 		_layout.size = _desiredLayout.size;
 		invalidateTransform();
 		invalidateContent();
 	}
 	else
 	{
-		_sizeAnimator.animate(&_layout.size, _layout.size, _desiredLayout.size, duration);
+		AnimationSystem::instance().animate(this, AnimatedProperty_Size, _layout.size, _desiredLayout.size, duration);
 	}
 	
 	didChangeFrame();
@@ -157,7 +226,7 @@ void Element2d::setVisible(bool vis, float duration)
 	setAlpha(vis ? 1.0f : 0.0f, duration);
 }
 
-const mat4& Element2d::transform()
+const Transform2d& Element2d::transform()
 {
 	if (!transformValid())
 		buildFinalTransform();
@@ -165,7 +234,7 @@ const mat4& Element2d::transform()
 	return _transform;
 }
 
-const mat4& Element2d::finalTransform()
+const Transform2d& Element2d::finalTransform()
 {
 	if (!transformValid())
 		buildFinalTransform();
@@ -173,24 +242,24 @@ const mat4& Element2d::finalTransform()
 	return _finalTransform;
 }
 
-mat4 Element2d::buildFinalTransform(const vec2& aOffset, float aAngle, const vec2& aScale, const vec2& aPosition)
+Transform2d Element2d::buildFinalTransform(const vec2& aOffset, float aAngle, const vec2& aScale, const vec2& aPosition)
 {
-	return translationMatrix(vec3(aOffset, 0.0f)) * transform2DMatrix(aAngle, aScale, aPosition);
+	return Transform2d::translationTransform(aOffset) * Transform2d(transform2DMatrix(aAngle, aScale, aPosition));
 }
 
 void Element2d::buildFinalTransform()
 {
 	_transform = buildFinalTransform(offset(), _layout.angle, _layout.scale, _layout.position);
 	_finalTransform = _transform * parentFinalTransform();
-	setTransformValid(true);
+	_validTransformStamp = effectiveTransformStamp();
 }
 
-const mat4& Element2d::finalInverseTransform()
+const Transform2d& Element2d::finalInverseTransform()
 {
 	if (!inverseTransformValid())
 	{
 		_finalInverseTransform = finalTransform().inverse();
-		setInverseTransformValid(true);
+		_validInverseTransformStamp = effectiveTransformStamp();
 	}
 
 	return _finalInverseTransform;
@@ -200,10 +269,10 @@ void Element2d::setDefaultProgram(const SceneProgram& p)
 	{ _defaultProgram = p; }
 
 const vec4& Element2d::ownColor() const
-	{ return _colorAnimator.value(); }
+	{ return _color; }
 
 vec4 Element2d::finalColor()
-	{ return vec4(_colorAnimator.value().xyz(), finalAlpha()); }
+	{ return vec4(_color.xyz(), finalAlpha()); }
 
 const vec2& Element2d::size() const
 	{ return _layout.size; }
@@ -242,7 +311,7 @@ void Element2d::setSize(float w, float h, float duration)
 
 bool Element2d::visible()
 {
-	return (_colorAnimator.value().w > 0.0f) && (finalAlpha() > 0.0f);
+	return (_color.w > 0.0f) && (finalAlpha() > 0.0f);
 }
 
 void Element2d::rotate(float anAngle, float duration)
@@ -254,6 +323,26 @@ bool Element2d::containsPoint(const vec2& p, const vec2&)
 bool Element2d::containLocalPoint(const vec2& p)
 	{ return (p.x >= 0.0f) && (p.y >= 0.0f) && (p.x < _layout.size.x) && (p.y < _layout.size.y); }
 
+bool Element2d::hitTestBounds(rect& bounds)
+{
+	/*
+	 * Bounds are built from the same inverse transform, which is used in containsPoint
+	 */
+	Transform2d t = finalInverseTransform().inverse();
+	vec2 corners[] = { t * vec2(0.0f), t * vec2(_layout.size.x, 0.0f), t * vec2(0.0f, _layout.size.y), t * _layout.size };
+	
+	vec2 minPos = corners[0];
+	vec2 maxPos = corners[0];
+	for (const auto& c : corners)
+	{
+		minPos = minv(minPos, c);
+		maxPos = maxv(maxPos, c);
+	}
+	
+	bounds = rect(minPos, maxPos - minPos);
+	return true;
+}
+
 vec2 Element2d::offset() const
 	{ return -_layout.size * _layout.pivotPoint; }
 
@@ -272,6 +361,12 @@ vec2 Element2d::contentSize()
 void Element2d::setParent(Element2d* element)
 {
 	ElementHierarchy::setParent(element);
+	hierarchyChanged();
+	
+	/*
+	 * New parent chain was not marked yet
+	 */
+	_propagationGeneration = 0;
 	invalidateContent();
 	invalidateTransform();
 }
@@ -279,45 +374,93 @@ void Element2d::setParent(Element2d* element)
 void Element2d::removeAllChildren()
 {
 	removeChildren();
+	hierarchyChanged();
 }
 
 void Element2d::childRemoved(Element2d*)
 {
+	hierarchyChanged();
 	invalidateContent();
 	invalidateTransform();
 }
 
 void Element2d::invalidateContent()
 {
-	_contentValid = false;
-	_finalAlphaValid = false;
-	
-	for (auto& c : children())
-		c->invalidateContent();
-	
+	_contentStamp = nextInvalidationStamp();
+	_contentVersion = _contentStamp;
 	setInvalid();
 }
 
 void Element2d::invalidateTransform()
 {
-	setTransformValid(false);
-	setInverseTransformValid(false);
+	_transformStamp = nextInvalidationStamp();
+	_contentVersion = _transformStamp;
+	++transformVersionValue;
+	setInvalid();
+}
+
+void Element2d::setContentValid()
+{
+	_validContentStamp = effectiveContentStamp();
+	_contentVersion = etMax(_validContentStamp, effectiveTransformStamp());
+}
+
+void Element2d::setInvalid()
+{
+	if (_propagationGeneration == invalidationPropagationGeneration) return;
 	
-	for (auto& c : children())
-		c->invalidateTransform();
+	_propagationGeneration = invalidationPropagationGeneration;
 	
-	setInvalid();
+	if (parent())
+		parent()->setInvalid();
+}
+
+void Element2d::startInvalidationPropagation()
+{
+	++invalidationPropagationGeneration;
+}
+
+void Element2d::resolveInheritedStamps()
+{
+	if (_inheritedStampsResolvedAt == latestInvalidationStamp) return;
+	
+	if (parent())
+	{
+		_inheritedContentStamp = parent()->contentStampForChildren();
+		_inheritedTransformStamp = parent()->transformStampForChildren();
+	}
+	else
+	{
+		_inheritedContentStamp = 0;
+		_inheritedTransformStamp = 0;
+	}
+	
+	_inheritedStampsResolvedAt = latestInvalidationStamp;
+}
+
+size_t Element2d::effectiveContentStamp()
+{
+	resolveInheritedStamps();
+	return etMax(_contentStamp, _inheritedContentStamp);
+}
+
+size_t Element2d::effectiveTransformStamp()
+{
+	resolveInheritedStamps();
+	return etMax(_transformStamp, _inheritedTransformStamp);
 }
 
 void Element2d::bringToFront(Element2d* c)
 {
 	ElementHierarchy::bringToFront(c);
+	hierarchyChanged();
 	invalidateContent();
 }
 
 void Element2d::sendToBack(Element2d* c)
 {
 	ElementHierarchy::sendToBack(c);
+	hierarchyChanged();
 	invalidateContent();
 }
 
@@ -569,10 +712,11 @@ void Element2d::autoLayoutFromFile(const std::string& fileName)
 
 float Element2d::finalAlpha()
 {
-	if (!_finalAlphaValid)
+	size_t stamp = effectiveContentStamp();
+	if (_validAlphaStamp < stamp)
 	{
-		_finalAlpha = ownColor().w * (parent() ? parent()->finalAlpha() : 1.0f);
-		_finalAlphaValid = true;
+		_finalAlpha = ownColor().w * (parent() ? parent()->alphaForChildren() : 1.0f);
+		_validAlphaStamp = stamp;
 	}
 	
 	return _finalAlpha;
@@ -0,0 +1,80 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/elementtree.h>
+
+using namespace et;
+using namespace et::s2d;
+
+void ElementTree::build(Element2d* root)
+{
+	_elements.clear();
+	_parent.clear();
+	_subtreeEnd.clear();
+
+	for (auto& c : root->children())
+		addSubtree(c.ptr(), InvalidIndex);
+
+	_nodeFlags.resize(_elements.size());
+	_hierarchyVersion = Element2d::hierarchyVersion();
+}
+
+void ElementTree::addSubtree(Element2d* e, uint32_t parent)
+{
+	uint32_t index = static_cast<uint32_t>(_elements.size());
+
+	_elements.push_back(e);
+	_parent.push_back(parent);
+	_subtreeEnd.push_back(InvalidIndex);
+
+	for (auto& c : e->children())
+		addSubtree(c.ptr(), index);
+
+	_subtreeEnd[index] = static_cast<uint32_t>(_elements.size());
+}
+
+void ElementTree::refreshState()
+{
+	uint32_t count = static_cast<uint32_t>(_elements.size());
+
+	for (uint32_t i = 0; i < count; )
+	{
+		Element2d* e = _elements[i];
+
+		if (!e->visible())
+		{
+			/*
+			 * Passes never look into hidden subtrees, so their state is just cleared
+			 */
+			std::fill(_nodeFlags.begin() + i, _nodeFlags.begin() + _subtreeEnd[i], 0);
+			i = _subtreeEnd[i];
+			continue;
+		}
+
+		uint32_t flags = NodeFlag_Visible;
+
+		if (e->hasFlag(Flag_ClipToBounds))
+			flags |= NodeFlag_ClipToBounds;
+
+		if (e->hasFlag(Flag_RenderTopmost))
+			flags |= NodeFlag_RenderTopmost;
+
+		if (e->hasFlag(Flag_RequiresPreRendering))
+			flags |= NodeFlag_RequiresPreRendering;
+		
+		if (e->hasFlag(Flag_CachedLayer))
+			flags |= NodeFlag_CachedLayer;
+
+		_nodeFlags[i++] = flags;
+	}
+}
+
+uint32_t ElementTree::indexOf(const Element2d* e) const
+{
+	auto i = std::find(_elements.begin(), _elements.end(), e);
+	return (i == _elements.end()) ? InvalidIndex : static_cast<uint32_t>(i - _elements.begin());
+}
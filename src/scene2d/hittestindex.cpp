@@ -0,0 +1,145 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <iterator>
+#include <et-ext/scene2d/hittestindex.h>
+
+using namespace et;
+using namespace et::s2d;
+
+/*
+ * Bounds are extended a little, so rounding in forward and inverse transforms
+ * could not exclude point accepted by containsPoint
+ */
+static const float boundsTolerance = 1.0f;
+
+int HitTestIndex::cellCoord(float value, int cells) const
+{
+	float cell = std::floor(value / static_cast<float>(CellSize));
+	return static_cast<int>(clamp(cell, 0.0f, static_cast<float>(cells - 1)));
+}
+
+HitTestIndex::CellRange HitTestIndex::cellRange(const rect& bounds) const
+{
+	CellRange result;
+	result.x0 = cellCoord(bounds.left - boundsTolerance, _gridSize.x);
+	result.y0 = cellCoord(bounds.top - boundsTolerance, _gridSize.y);
+	result.x1 = cellCoord(bounds.left + bounds.width + boundsTolerance, _gridSize.x);
+	result.y1 = cellCoord(bounds.top + bounds.height + boundsTolerance, _gridSize.y);
+	return result;
+}
+
+/*
+ * Every cell and list of unbounded elements are kept sorted in tree order
+ */
+static void insertSorted(std::vector<uint32_t>& v, uint32_t value)
+	{ v.insert(std::lower_bound(v.begin(), v.end(), value), value); }
+
+static void eraseSorted(std::vector<uint32_t>& v, uint32_t value)
+{
+	auto i = std::lower_bound(v.begin(), v.end(), value);
+	if ((i != v.end()) && (*i == value))
+		v.erase(i);
+}
+
+void HitTestIndex::addToCells(uint32_t i)
+{
+	if (_bounded[i])
+	{
+		CellRange r = cellRange(_bounds[i]);
+		for (int y = r.y0; y <= r.y1; ++y)
+		{
+			for (int x = r.x0; x <= r.x1; ++x)
+				insertSorted(_cells[y * _gridSize.x + x], i);
+		}
+	}
+	else
+	{
+		insertSorted(_unbounded, i);
+	}
+}
+
+void HitTestIndex::removeFromCells(uint32_t i)
+{
+	if (_bounded[i])
+	{
+		CellRange r = cellRange(_bounds[i]);
+		for (int y = r.y0; y <= r.y1; ++y)
+		{
+			for (int x = r.x0; x <= r.x1; ++x)
+				eraseSorted(_cells[y * _gridSize.x + x], i);
+		}
+	}
+	else
+	{
+		eraseSorted(_unbounded, i);
+	}
+}
+
+void HitTestIndex::build(const ElementTree& tree, const vec2& area)
+{
+	uint32_t count = static_cast<uint32_t>(tree.size());
+
+	vec2i gridSize(etMax(1, static_cast<int>(std::ceil(area.x / static_cast<float>(CellSize)))),
+		etMax(1, static_cast<int>(std::ceil(area.y / static_cast<float>(CellSize)))));
+
+	/*
+	 * Tree indices change with hierarchy, so then every element is bucketed again
+	 */
+	bool rebuild = (_hierarchyVersion != Element2d::hierarchyVersion()) ||
+		(gridSize.x != _gridSize.x) || (gridSize.y != _gridSize.y) || (_bounds.size() != count);
+
+	if (rebuild)
+	{
+		_gridSize = gridSize;
+		_cells.resize(_gridSize.x * _gridSize.y);
+		for (auto& cell : _cells)
+			cell.clear();
+		_unbounded.clear();
+
+		_bounds.resize(count);
+		_boundsStamp.resize(count, 0);
+		_boundsElement.resize(count, nullptr);
+		_bounded.resize(count, false);
+	}
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Element2d* e = tree.element(i);
+		size_t stamp = e->effectiveTransformStamp();
+		bool changed = (_boundsElement[i] != e) || (_boundsStamp[i] != stamp);
+
+		if (!changed && !rebuild) continue;
+
+		if (!rebuild)
+			removeFromCells(i);
+
+		if (changed)
+		{
+			rect& b = _bounds[i];
+			bool bounded = e->hitTestBounds(b);
+			_bounded[i] = bounded && std::isfinite(b.left) && std::isfinite(b.top) &&
+				std::isfinite(b.width) && std::isfinite(b.height);
+			_boundsElement[i] = e;
+			_boundsStamp[i] = stamp;
+		}
+
+		addToCells(i);
+	}
+
+	_hierarchyVersion = Element2d::hierarchyVersion();
+	_transformVersion = Element2d::transformVersion();
+}
+
+const std::vector<uint32_t>& HitTestIndex::candidates(const vec2& p)
+{
+	const auto& cell = _cells[cellCoord(p.y, _gridSize.y) * _gridSize.x + cellCoord(p.x, _gridSize.x)];
+
+	_candidates.clear();
+	std::merge(cell.begin(), cell.end(), _unbounded.begin(), _unbounded.end(), std::back_inserter(_candidates));
+	return _candidates;
+}
@@ -10,6 +10,10 @@
 using namespace et;
 using namespace s2d;
 
+extern std::string et_scene2d_image_shader_vs;
+extern std::string et_scene2d_nine_slice_shader_fs;
+extern std::string et_scene2d_tiling_shader_fs;
+
 ET_DECLARE_SCENE_ELEMENT_CLASS(ImageView)
 
 ImageView::ImageView(Element2d* parent, const std::string& name) :
@@ -60,12 +64,19 @@ void ImageView::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
 
 	if (_vertices.lastElementIndex())
 		r.addVertices(_vertices, _texture, program(), this);
+	
+	if (_shaderVertices.lastElementIndex())
+	{
+		r.addVertices(_shaderVertices, _texture, _shaderVerticesTiled ?
+			tilingProgram(r) : nineSliceProgram(r), this);
+	}
 }
 
-void ImageView::buildVertices(RenderContext*, SceneRenderer&)
+void ImageView::buildVertices(RenderContext*, SceneRenderer& r)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	_vertices.setOffset(0);
+	_shaderVertices.setOffset(0);
 	
 	vec4 alphaScale = vec4(1.0f, finalAlpha());
 	
@@ -82,31 +93,125 @@ void ImageView::buildVertices(RenderContext*, SceneRenderer&)
 
 			size_t repeatsWidth = etMax(static_cast<size_t>(1), static_cast<size_t>(size().x / _descriptor.value().size.x));
 			size_t repeatsHeight = etMax(static_cast<size_t>(1), static_cast<size_t>(size().y / _descriptor.value().size.y));
-
-			_vertices.fitToSize(repeatsWidth * repeatsHeight * measuseVertexCountForImageDescriptor(_descriptor.value()));
-
-			for (size_t v = 0; v < repeatsHeight; ++v)
+			
+			if (shouldUseShaderTiling(r, _descriptor.value()))
+			{
+				vec2 repeats(static_cast<float>(repeatsWidth), static_cast<float>(repeatsHeight));
+				
+				_shaderParameters = imageTexCoordRect(_texture, _descriptor.value());
+				_shaderVerticesTiled = true;
+				buildTiledImageVertices(_shaderVertices, _texture, rect(vec2(0.0f), repeats * _descriptor.value().size),
+					repeats, finalColor(), transform);
+			}
+			else
 			{
-				for (size_t u = 0; u < repeatsWidth; ++u)
+				_vertices.fitToSize(repeatsWidth * repeatsHeight * measuseVertexCountForImageDescriptor(_descriptor.value()));
+
+				for (size_t v = 0; v < repeatsHeight; ++v)
 				{
-					float fx = static_cast<float>(u * _descriptor.value().size.x);
-					float fy = static_cast<float>(v * _descriptor.value().size.y);
-					buildImageVertices(_vertices, _texture, _descriptor.value(),
-						rect(vec2(fx, fy), _descriptor.value().size), finalColor(), transform);
+					for (size_t u = 0; u < repeatsWidth; ++u)
+					{
+						float fx = static_cast<float>(u * _descriptor.value().size.x);
+						float fy = static_cast<float>(v * _descriptor.value().size.y);
+						buildImageVertices(_vertices, _texture, _descriptor.value(),
+							rect(vec2(fx, fy), _descriptor.value().size), finalColor(), transform);
+					}
 				}
 			}
 		}
 		else
 		{
 			auto frame = calculateImageFrame();
-			buildImageVertices(_vertices, _texture, frame,
-				rect(_actualImageOrigin, _actualImageSize), finalColor(), transform);
+			if (shouldUseShaderNineSlice(r, frame))
+			{
+				_shaderParameters = nineSliceParameters(_texture, frame);
+				_shaderVerticesTiled = false;
+				buildNineSliceImageVertices(_shaderVertices, _texture, frame,
+					rect(_actualImageOrigin, _actualImageSize), finalColor(), transform);
+			}
+			else
+			{
+				buildImageVertices(_vertices, _texture, frame,
+					rect(_actualImageOrigin, _actualImageSize), finalColor(), transform);
+			}
 		}
 	}
 
 	setContentValid();
 }
 
+static bool hasSlices(const ContentOffset& offset)
+	{ return (offset.left > 0.0f) || (offset.top > 0.0f) || (offset.right > 0.0f) || (offset.bottom > 0.0f); }
+
+bool ImageView::defaultVertexFormat(SceneRenderer& r) const
+{
+	/*
+	 * texCoord.zw is stored with reduced precision in packed and instanced formats
+	 */
+	return r.renderingElement().valid() &&
+		(r.renderingElement()->vertexFormat() == RenderingElement::VertexFormat::Default);
+}
+
+bool ImageView::shouldUseShaderNineSlice(SceneRenderer& r, const ImageDescriptor& frame) const
+{
+	if (!_shaderNineSlice) return false;
+	
+	/*
+	 * Center part should have non-zero size to be resolved in shader
+	 */
+	const ContentOffset& offset = frame.contentOffset;
+	return hasSlices(offset) && defaultVertexFormat(r) && (std::abs(_actualImageSize.x) > offset.left + offset.right) &&
+		(std::abs(_actualImageSize.y) > offset.top + offset.bottom);
+}
+
+bool ImageView::shouldUseShaderTiling(SceneRenderer& r, const ImageDescriptor& desc) const
+	{ return _shaderTiling && !hasSlices(desc.contentOffset) && defaultVertexFormat(r); }
+
+const SceneProgram& ImageView::nineSliceProgram(SceneRenderer& r)
+{
+	if (_nineSliceProgram.invalid())
+	{
+		_nineSliceProgram = r.createProgramWithShaders("et-scene2d-nine-slice",
+			et_scene2d_image_shader_vs, et_scene2d_nine_slice_shader_fs);
+	}
+	
+	return _nineSliceProgram;
+}
+
+const SceneProgram& ImageView::tilingProgram(SceneRenderer& r)
+{
+	if (_tilingProgram.invalid())
+		_tilingProgram = r.createProgramWithShaders("et-scene2d-tiling", et_scene2d_image_shader_vs, et_scene2d_tiling_shader_fs);
+	
+	return _tilingProgram;
+}
+
+void ImageView::setShaderNineSlice(bool enabled)
+{
+	if (enabled == _shaderNineSlice) return;
+	
+	_shaderNineSlice = enabled;
+	updateObjectParametersFlag();
+	invalidateContent();
+}
+
+void ImageView::setShaderTiling(bool enabled)
+{
+	if (enabled == _shaderTiling) return;
+	
+	_shaderTiling = enabled;
+	updateObjectParametersFlag();
+	invalidateContent();
+}
+
+void ImageView::updateObjectParametersFlag()
+{
+	if (_shaderNineSlice || _shaderTiling)
+		setFlag(Flag_HasObjectParameters);
+	else
+		removeFlag(Flag_HasObjectParameters);
+}
+
 void ImageView::setImageDescriptor(const ImageDescriptor& d, float duration)
 {
 	_descriptor.animate(d, duration);
@@ -218,3 +323,62 @@ vec2 ImageView::contentSize()
 {
 	return _descriptor.value().size;
 }
+
+/*
+ * Object parameters contain texCoords of image rect or of its center part
+ */
+std::string et_scene2d_image_shader_vs =
+"uniform mat4 mTransform;"
+"uniform vec3 additionalOffsetAndAlpha;"
+"uniform vec4 objectParameters[" + intToStr(ObjectParameters_MaxObjects) + "];"
+"etVertexIn vec3 Vertex;"
+"etVertexIn vec4 TexCoord0;"
+"etVertexIn vec4 Color;"
+"etVertexOut etHighp vec4 imageTexCoord;"
+"etVertexOut etHighp vec4 imageParameters;"
+"etVertexOut etLowp vec4 tintColor;"
+"void main()"
+"{"
+"	imageTexCoord = TexCoord0;"
+"	imageParameters = objectParameters[int(Vertex.z)];"
+"	tintColor = Color * vec4(1.0, 1.0, 1.0, additionalOffsetAndAlpha.z);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
+"	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
+"}";
+
+/*
+ * Quad is mapped to the texture one to one from both ends, parts between
+ * the center part edges are stretched, the rest is taken from one of the ends
+ */
+std::string et_scene2d_nine_slice_shader_fs =
+"uniform etLowp sampler2D inputTexture;"
+"etFragmentIn etHighp vec4 imageTexCoord;"
+"etFragmentIn etHighp vec4 imageParameters;"
+"etFragmentIn etLowp vec4 tintColor;"
+"void main()"
+"{"
+"	etHighp vec2 startOffset = imageTexCoord.xy - imageParameters.xy;"
+"	etHighp vec2 endOffset = imageParameters.zw - imageTexCoord.zw;"
+"	etHighp vec2 t = startOffset / (startOffset + endOffset);"
+"	etHighp vec2 texCoord = mix(imageParameters.xy, imageParameters.zw, clamp(t, 0.0, 1.0));"
+"	texCoord = mix(texCoord, imageTexCoord.xy, vec2(lessThan(t, vec2(0.0))));"
+"	texCoord = mix(texCoord, imageTexCoord.zw, vec2(greaterThan(t, vec2(1.0))));"
+"	etFragmentOut = etTexture2D(inputTexture, texCoord) * tintColor;"
+"}";
+
+/*
+ * imageTexCoord.xy - position in tiles, imageTexCoord.zw - half of texel,
+ * wrapped texCoords are kept half texel inside of image rect, so atlas neighbours are not sampled
+ */
+std::string et_scene2d_tiling_shader_fs =
+"uniform etLowp sampler2D inputTexture;"
+"etFragmentIn etHighp vec4 imageTexCoord;"
+"etFragmentIn etHighp vec4 imageParameters;"
+"etFragmentIn etLowp vec4 tintColor;"
+"void main()"
+"{"
+"	etHighp vec2 texCoord = mix(imageParameters.xy, imageParameters.zw, fract(imageTexCoord.xy));"
+"	etHighp vec2 minTexCoord = min(imageParameters.xy, imageParameters.zw) + imageTexCoord.zw;"
+"	etHighp vec2 maxTexCoord = max(imageParameters.xy, imageParameters.zw) - imageTexCoord.zw;"
+"	etFragmentOut = etTexture2D(inputTexture, clamp(texCoord, minTexCoord, maxTexCoord)) * tintColor;"
+"}";
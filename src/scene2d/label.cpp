@@ -43,7 +43,7 @@ void Label::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
 
 void Label::buildVertices(RenderContext*, SceneRenderer&)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	vec2 alignment = vec2(alignmentFactor(_horizontalAlignment), alignmentFactor(_verticalAlignment));
 	vec2 textOffset = size() * alignment;
 	
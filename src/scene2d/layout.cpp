@@ -24,56 +24,131 @@ Layout::Layout(const std::string& name) :
 		LayoutMode_RelativeToContext, vec2(0.0f));
 }
 
-void Layout::addElementToRenderQueue(Element2d::Pointer& element, RenderContext* rc, SceneRenderer& gr)
+void Layout::addElementToRenderQueue(uint32_t index, RenderContext* rc, SceneRenderer& gr)
 {
-	if (!element->visible()) return;
+	if (!_elementTree.hasFlag(index, ElementTree::NodeFlag_Visible)) return;
 
-	bool clipToBounds = element->hasFlag(Flag_ClipToBounds);
+	Element2d* element = _elementTree.element(index);
+	bool clipToBounds = _elementTree.hasFlag(index, ElementTree::NodeFlag_ClipToBounds);
 
 	if (clipToBounds)
 	{
-		const mat4& parentTransform = element->parent()->finalTransform();
+		const Transform2d& parentTransform = element->parent()->finalTransform();
 		
 		vec2 eSize = multiplyWithoutTranslation(element->size(), parentTransform);
 		vec2 eOrigin = parentTransform * element->origin();
 		
-		gr.pushClipRect(recti(vec2i(static_cast<int>(eOrigin.x),
-			static_cast<int>(rc->size().y - eOrigin.y - eSize.y)),
-			vec2i(static_cast<int>(eSize.x), static_cast<int>(eSize.y))));
+		recti clipRect(vec2i(static_cast<int>(eOrigin.x), static_cast<int>(gr.windowSize().y - eOrigin.y - eSize.y)),
+			vec2i(static_cast<int>(eSize.x), static_cast<int>(eSize.y)));
+		
+		/*
+		 * Element clips its own content and children, nothing to render if it is outside of current clip
+		 */
+		if (!gr.clipRectVisible(clipRect))
+			return;
+		
+		gr.pushClipRect(clipRect);
 	}
 	
 	element->addToRenderQueue(rc, gr);
-	for (auto& c : element->children())
+	
+	/*
+	 * Children of cached layer are rendered into its texture by scene
+	 */
+	if (!_elementTree.hasFlag(index, ElementTree::NodeFlag_CachedLayer))
 	{
-		if (!elementIsBeingDragged(c))
-			addElementToRenderQueue(c, rc, gr);
+		for (uint32_t c = index + 1, e = _elementTree.subtreeEnd(index); c < e; c = _elementTree.subtreeEnd(c))
+		{
+			if (!elementIsBeingDragged(_elementTree.element(c)))
+				addElementToRenderQueue(c, rc, gr);
+		}
 	}
+	
 	element->addToOverlayRenderQueue(rc, gr);
 	
 	if (clipToBounds)
 		gr.popClipRect();
 }
 
+void Layout::collectParallelBuildElements()
+{
+	_parallelBuildElements.clear();
+	
+	uint32_t count = static_cast<uint32_t>(_elementTree.size());
+	for (uint32_t i = 0; i < count; )
+	{
+		if (!_elementTree.hasFlag(i, ElementTree::NodeFlag_Visible))
+		{
+			i = _elementTree.subtreeEnd(i);
+			continue;
+		}
+		
+		Element2d* element = _elementTree.element(i);
+		i = _elementTree.hasFlag(i, ElementTree::NodeFlag_CachedLayer) ? _elementTree.subtreeEnd(i) : i + 1;
+		
+		if (element->supportsParallelVertexBuild() && (!element->contentValid() || !element->transformValid()))
+		{
+			/*
+			 * Lazily calculated values could be shared with siblings through parent,
+			 * so they are resolved here, before workers start
+			 */
+			element->finalTransform();
+			element->finalAlpha();
+			_parallelBuildElements.push_back(element);
+		}
+	}
+}
+
+void Layout::buildVerticesInParallel(RenderContext* rc, SceneRenderer& gr)
+{
+	collectParallelBuildElements();
+	
+	/*
+	 * Transforms are already marked valid here, so elements are rebuilt even when pool is not used.
+	 * Vertices are added to render queue by the regular pass in draw order, chunks are the same as in serial build
+	 */
+	if (_parallelBuildElements.size() < MinParallelBuildElements)
+	{
+		for (auto e : _parallelBuildElements)
+			e->buildVerticesInParallel(rc, gr);
+	}
+	else
+	{
+		gr.vertexBuildPool()->run(_parallelBuildElements.size(), [this, rc, &gr](size_t i)
+			{ _parallelBuildElements[i]->buildVerticesInParallel(rc, gr); });
+	}
+}
+
 void Layout::addToRenderQueue(RenderContext* rc, SceneRenderer& gr)
 {
 	gr.resetClipRect();
+	updateElementTree();
+	
+	if (gr.vertexBuildPool().valid())
+		buildVerticesInParallel(rc, gr);
 	
-	for (auto& c : children())
+	uint32_t count = static_cast<uint32_t>(_elementTree.size());
+	for (uint32_t c = 0; c < count; c = _elementTree.subtreeEnd(c))
 	{
-		if (!elementIsBeingDragged(c))
+		if (!elementIsBeingDragged(_elementTree.element(c)))
 			addElementToRenderQueue(c, rc, gr);
 	}
 
-	for (auto& t : _topmostElements)
+	for (auto t : _topmostElements)
 	{
-		if (!elementIsBeingDragged(t))
+		if (!elementIsBeingDragged(_elementTree.element(t)))
 			addElementToRenderQueue(t, rc, gr);
 	}
 	
-	if (elementIsBeingDragged(_capturedElement))
-		addElementToRenderQueue(_capturedElement, rc, gr);
+	if (elementIsBeingDragged(_capturedElement.ptr()))
+	{
+		uint32_t capturedIndex = _elementTree.indexOf(_capturedElement.ptr());
+		if (capturedIndex != ElementTree::InvalidIndex)
+			addElementToRenderQueue(capturedIndex, rc, gr);
+	}
 	
 	_valid = true;
+	startInvalidationPropagation();
 }
 
 bool Layout::pointerPressed(const et::PointerInputInfo& p)
@@ -280,25 +355,36 @@ bool Layout::pointerScrolled(const et::PointerInputInfo& p)
 
 Element2d::Pointer Layout::activeElement(const PointerInputInfo& p)
 {
-	if (!_valid)
+	if (_elementTree.outdated() || _hitTestIndex.outdated())
 	{
-		_topmostElements.clear();
-		for (auto& i : children())
-			collectTopmostElements(i);
+		updateElementTree();
+		_hitTestIndex.build(_elementTree, size());
 	}
+	
+	/*
+	 * Elements, which are not candidates, could not contain the point,
+	 * the rest of them are visited in the same order as the tree itself
+	 */
+	const auto& candidates = _hitTestIndex.candidates(p.pos);
 
 	Element2d::Pointer active;
 	for (auto i = _topmostElements.rbegin(), e = _topmostElements.rend(); i != e; ++i)
 	{
-		active = getActiveElement(p, *i);
-		if (active.valid())	break;
+		auto c = std::lower_bound(candidates.begin(), candidates.end(), *i);
+		if ((c != candidates.end()) && (*c == *i))
+		{
+			active = getActiveElement(p, candidates, c - candidates.begin());
+			if (active.valid())	break;
+		}
 	}
 
 	if (active.invalid())
 	{
-		for (auto i = children().rbegin(), e = children().rend(); i != e; ++i)
+		for (size_t c = candidates.size(); c > 0; --c)
 		{
-			active = getActiveElement(p, *i);
+			if (_elementTree.parent(candidates[c - 1]) != ElementTree::InvalidIndex) continue;
+			
+			active = getActiveElement(p, candidates, c - 1);
 			if (active.valid())	break;
 		}
 	}
@@ -306,22 +392,29 @@ Element2d::Pointer Layout::activeElement(const PointerInputInfo& p)
 	return active;
 }
 
-Element2d::Pointer Layout::getActiveElement(const PointerInputInfo& p, Element2d::Pointer el)
+Element2d::Pointer Layout::getActiveElement(const PointerInputInfo& p, const std::vector<uint32_t>& candidates,
+	size_t position)
 {
+	uint32_t index = candidates[position];
+	Element2d* el = _elementTree.element(index);
+	
 	if (!el->visible() || !el->enabled() || !el->containsPoint(p.pos, p.normalizedPos))
 		return Element2d::Pointer();
 	
 	if (el->hasFlag(Flag_HandlesChildEvents))
-		return el;
+		return Element2d::Pointer(el);
 
-	for (auto ei = el->children().rbegin(), ee = el->children().rend(); ei != ee; ++ei)
+	auto subtreeEnd = std::lower_bound(candidates.begin() + position + 1, candidates.end(), _elementTree.subtreeEnd(index));
+	for (size_t c = subtreeEnd - candidates.begin(); c > position + 1; --c)
 	{
-		Element2d::Pointer element = getActiveElement(p, *ei);
+		if (_elementTree.parent(candidates[c - 1]) != index) continue;
+		
+		Element2d::Pointer element = getActiveElement(p, candidates, c - 1);
 		if (element.valid())
 			return element;
 	}
 
-	return el->hasFlag(Flag_TransparentForPointer) ? Element2d::Pointer() : el;
+	return el->hasFlag(Flag_TransparentForPointer) ? Element2d::Pointer() : Element2d::Pointer(el);
 }
 
 void Layout::setCurrentElement(const PointerInputInfo& p, Element2d::Pointer e)
@@ -356,9 +449,9 @@ void Layout::performDragging(const PointerInputInfo& p)
 		ElementDragInfo(_capturedElement->position(), _dragInitialPosition, p.normalizedPos));
 }
 
-bool Layout::elementIsBeingDragged(s2d::Element2d::Pointer e)
+bool Layout::elementIsBeingDragged(const Element2d* e)
 {
-	return _dragging && e.valid() && (e == _capturedElement);
+	return _dragging && (e != nullptr) && (e == _capturedElement.ptr());
 }
 
 void Layout::update(float)
@@ -412,34 +505,72 @@ void Layout::setInvalid()
 	_valid = false;
 }
 
-void Layout::collectPreRenderingObjects(Element2d::Pointer element, Element2d::List& elementList)
+void Layout::updateElementTree()
 {
-	if (element->visible())
+	if (_elementTree.outdated())
+		_elementTree.build(this);
+	
+	_elementTree.refreshState();
+	
+	_topmostElements.clear();
+	for (uint32_t i = 0, e = static_cast<uint32_t>(_elementTree.size()); i < e; )
 	{
-		if (element->hasFlag(Flag_RequiresPreRendering))
-			elementList.push_back(Element2d::Pointer(element));
+		if (_elementTree.hasFlag(i, ElementTree::NodeFlag_Visible | ElementTree::NodeFlag_RenderTopmost))
+			_topmostElements.push_back(i);
 		
-		for (auto& i : element->children())
-			collectPreRenderingObjects(i, elementList);
+		i = _elementTree.hasFlag(i, ElementTree::NodeFlag_CachedLayer) ? _elementTree.subtreeEnd(i) : i + 1;
 	}
 }
 
-void Layout::collectTopmostElements(Element2d::Pointer element)
+/*
+ * Collects elements with Flag_RequiresPreRendering and Flag_CachedLayer regardless of visibility,
+ * scene keeps them until hierarchy or flags are changed
+ */
+void Layout::collectPreRenderingObjects(std::vector<Element2d*>& elementList, std::vector<Element2d*>& cachedLayers)
 {
-	if (element->visible())
+	if (hasFlag(Flag_RequiresPreRendering))
+		elementList.push_back(this);
+	
+	if (_elementTree.outdated())
+		_elementTree.build(this);
+	
+	for (uint32_t i = 0, e = static_cast<uint32_t>(_elementTree.size()); i < e; ++i)
 	{
-		if (element->hasFlag(Flag_RenderTopmost))
-			_topmostElements.push_back(Element2d::Pointer(element));
+		Element2d* element = _elementTree.element(i);
+		
+		if (element->hasFlag(Flag_RequiresPreRendering))
+			elementList.push_back(element);
 		
-		for (auto& i : element->children())
-			collectTopmostElements(i);
+		if (element->hasFlag(Flag_CachedLayer))
+			cachedLayers.push_back(element);
 	}
 }
 
-void Layout::initRenderingElement(et::RenderContext* rc)
+void Layout::initRenderingElement(et::RenderContext* rc, const RenderBackend::Pointer& backend)
 {
 	if (_renderingElement.invalid())
-		_renderingElement = RenderingElement::Pointer::create(rc, RenderingElement::MaxCapacity);
+	{
+		_renderingElement = RenderingElement::Pointer::create(rc, _vertexCapacity,
+			_streamingMode, _vertexFormat, backend);
+	}
+}
+
+void Layout::setVertexFormat(RenderingElement::VertexFormat format)
+{
+	ET_ASSERT(_renderingElement.invalid() && "Vertex format should be set before layout is added to the scene");
+	_vertexFormat = format;
+}
+
+void Layout::setStreamingMode(RenderingElement::StreamingMode mode)
+{
+	ET_ASSERT(_renderingElement.invalid() && "Streaming mode should be set before layout is added to the scene");
+	_streamingMode = mode;
+}
+
+void Layout::setVertexCapacity(size_t capacity)
+{
+	ET_ASSERT(_renderingElement.invalid() && "Vertex capacity should be set before layout is added to the scene");
+	_vertexCapacity = QuadGeometry_Vertices * etMax(size_t(1), (capacity + QuadGeometry_Vertices - 1) / QuadGeometry_Vertices);
 }
 
 vec2 Layout::contentSize()
@@ -25,9 +25,15 @@ Line::Line(const vec2& from, const vec2& to, Element2d* parent) :
 	fillParent();
 }
 
+/*
+ * Limit for recursive subdivision of the curve
+ */
+static const size_t maxSubdivisionDepth = 16;
+
 void Line::setType(Type t)
 {
 	_type = t;
+	_curveValid = false;
 	invalidateContent();
 }
 
@@ -35,6 +41,7 @@ void Line::setControlPoint(size_t index, const vec2& p)
 {
 	ET_ASSERT(index < _controlPoints.size());
 	_controlPoints[index] = p;
+	_curveValid = false;
 	invalidateContent();
 }
 
@@ -44,92 +51,161 @@ void Line::setWidth(float w)
 	invalidateContent();
 }
 
+void Line::setTolerance(float t)
+{
+	ET_ASSERT(t > 0.0f);
+	_tolerance = t;
+	_curveValid = false;
+	invalidateContent();
+}
+
 void Line::addToRenderQueue(RenderContext*, SceneRenderer& r)
 {
 	initProgram(r);
 	
-	if (!contentValid())
+	if (!contentValid() || !transformValid())
 		buildVertices(r);
 	
 	r.addVertices(_vertices, Texture::Pointer(), program(), this);
 }
 
-void Line::buildLine(const vec2& p1, const vec2& p2, const vec4& tc, const vec4& clr1, const vec4& clr2, const mat4& t)
+vec2 Line::curvePoint(float t) const
 {
-	vec2 n = 0.5f * _width * normalize(vec2(p2.y - p1.y, p1.x - p2.x));
-	SceneVertex tl(t * (p1 - n), tc, clr1);
-	SceneVertex tr(t * (p1 + n), tc, clr1);
-	SceneVertex bl(t * (p2 - n), tc, clr2);
-	SceneVertex br(t * (p2 + n), tc, clr2);
-	buildQuad(_vertices, tl, tr, bl, br);
+	if (_type == Type_Linear)
+		return _curveOrigin + _curveSize * mix(_controlPoints.front(), _controlPoints.back(), t);
+	
+	return _curveOrigin + _curveSize * bezierCurve(_controlPoints.data(), _controlPoints.size(), t);
 }
 
-void Line::buildVertices(SceneRenderer&)
+/*
+ * For quadratic curve distance between midpoints of the arc and of the chord
+ * is the largest deviation of the chord from the arc
+ */
+void Line::tessellateCurve(float t0, const vec2& p0, float t1, const vec2& p1, size_t depth)
 {
-	_vertices.setOffset(0);
+	float tm = 0.5f * (t0 + t1);
+	vec2 pm = curvePoint(tm);
+	vec2 deviation = pm - 0.5f * (p0 + p1);
 	
-	vec4 baseColor = finalColor();
-	vec4 texCoord(0.0f, 0.0f, 0.0f, 1.0f);
-	mat4 tr = finalTransform();
+	if ((depth < maxSubdivisionDepth) && (deviation.dotSelf() > sqr(_tolerance)))
+	{
+		tessellateCurve(t0, p0, tm, pm, depth + 1);
+		tessellateCurve(tm, pm, t1, p1, depth + 1);
+	}
+	else if ((p1 - _curvePoints.back()).dotSelf() > std::numeric_limits<float>::epsilon())
+	{
+		_curvePoints.push_back(p1);
+		_curveParameters.push_back(t1);
+	}
+}
+
+void Line::buildCurve()
+{
+	_curveOrigin = origin();
+	_curveSize = size();
+	
+	_curvePoints.clear();
+	_curveParameters.clear();
+	
+	vec2 p0 = curvePoint(0.0f);
+	vec2 p1 = curvePoint(1.0f);
+	
+	_curvePoints.push_back(p0);
+	_curveParameters.push_back(0.0f);
 	
 	if (_type == Type_Linear)
 	{
-		if (_shadowColor.w > 0.0f)
-		{
-			vec2 p1 = origin() + size() * _controlPoints.front() + _shadowOffset;
-			vec2 p2 = origin() + size() * _controlPoints.back() + _shadowOffset;
-			buildLine(p1, p2, texCoord, _shadowColor, _shadowColor, tr);
-		}
-		
-		vec2 p1 = origin() + size() * _controlPoints.front();
-		vec2 p2 = origin() + size() * _controlPoints.back();
-		buildLine(p1, p2, texCoord, baseColor * _startColor, baseColor * _endColor, tr);
+		tessellateCurve(0.0f, p0, 1.0f, p1, maxSubdivisionDepth);
 	}
 	else if (_type == Type_QuadraticBezier)
 	{
-		vec2 cp1 = origin() + size() * _controlPoints[0];
-		vec2 cp2 = origin() + size() * _controlPoints[1];
-		vec2 cp3 = origin() + size() * _controlPoints[2];
-		
-		float curveLength = 0.0f;
-		float t = 0.0f;
-		float dt = 0.0001f;
-		while (t <= 1.0f)
-		{
-			vec2 dCdT = 2.0f * (cp1 * (t - 1.0f) + cp2 * (1.0f - 2.0f * t) + cp3 * t);
-			curveLength += dt * std::sqrt(dCdT.dotSelf());
-			t += dt;
-		}
-		dt = 1.0f / std::sqrt(curveLength);
-		
-		if (_shadowColor.w > 0.0f)
-		{
-			t = 0.0f;
-			while (t < 1.0f)
-			{
-				vec2 p1 = origin() + size() * bezierCurve(_controlPoints.data(), _controlPoints.size(), t) + _shadowOffset;
-				vec2 p2 = origin() + size() * bezierCurve(_controlPoints.data(), _controlPoints.size(), etMin(1.0f, t + dt)) + _shadowOffset;
-				buildLine(p1, p2, texCoord, _shadowColor, _shadowColor, tr);
-				t += dt;
-			}
-		}
-
-		t = 0.0f;
-		while (t < 1.0f)
-		{
-			vec4 c1 = mix(_startColor, _endColor, t);
-			vec4 c2 = mix(_startColor, _endColor, t + dt);
-			vec2 p1 = origin() + size() * bezierCurve(_controlPoints.data(), _controlPoints.size(), t);
-			vec2 p2 = origin() + size() * bezierCurve(_controlPoints.data(), _controlPoints.size(), etMin(1.0f, t + dt));
-			buildLine(p1, p2, texCoord, baseColor * c1, baseColor * c2, tr);
-			t += dt;
-		}
+		/*
+		 * Curve is split at the middle first, so closed and symmetric curves are not taken as flat
+		 */
+		vec2 pm = curvePoint(0.5f);
+		tessellateCurve(0.0f, p0, 0.5f, pm, 1);
+		tessellateCurve(0.5f, pm, 1.0f, p1, 1);
 	}
 	else
 	{
 		ET_FAIL("Invalid line type.")
 	}
 	
+	size_t pointsCount = _curvePoints.size();
+	_curveNormals.resize((pointsCount < 2) ? 0 : pointsCount - 1);
+	
+	for (size_t i = 0; i < _curveNormals.size(); ++i)
+	{
+		vec2 d = _curvePoints[i + 1] - _curvePoints[i];
+		_curveNormals[i] = normalize(vec2(d.y, -d.x));
+	}
+	
+	_curveValid = true;
+}
+
+void Line::buildStrip(const vec2& offset, const vec4& clr1, const vec4& clr2, const vec4& tc, const Transform2d& t)
+{
+	float halfWidth = 0.5f * _width;
+	
+	for (size_t i = 0, e = _curveNormals.size(); i < e; ++i)
+	{
+		vec2 p1 = _curvePoints[i] + offset;
+		vec2 p2 = _curvePoints[i + 1] + offset;
+		vec2 n = halfWidth * _curveNormals[i];
+		vec4 c1 = mix(clr1, clr2, _curveParameters[i]);
+		vec4 c2 = mix(clr1, clr2, _curveParameters[i + 1]);
+		
+		SceneVertex tl(t * (p1 - n), tc, c1);
+		SceneVertex tr(t * (p1 + n), tc, c1);
+		SceneVertex bl(t * (p2 - n), tc, c2);
+		SceneVertex br(t * (p2 + n), tc, c2);
+		buildQuad(_vertices, tl, tr, bl, br);
+		
+		if (i + 1 < e)
+			buildJoint(p2, _curveNormals[i], _curveNormals[i + 1], c2, tc, t);
+	}
+}
+
+/*
+ * Gap between segments on the outer side of the turn is covered with parallelogram
+ * built on both normals, it contains the miter joint and only slightly exceeds it
+ * for turns made by tessellated curve
+ */
+void Line::buildJoint(const vec2& p, const vec2& n1, const vec2& n2, const vec4& clr, const vec4& tc, const Transform2d& t)
+{
+	if (dot(n1, n2) > 1.0f - std::numeric_limits<float>::epsilon())
+		return;
+	
+	vec2 previousDirection(-n1.y, n1.x);
+	float side = (dot(n2, previousDirection) > 0.0f) ? 0.5f * _width : -0.5f * _width;
+	
+	SceneVertex tl(t * p, tc, clr);
+	SceneVertex tr(t * (p + side * n1), tc, clr);
+	SceneVertex bl(t * (p + side * n2), tc, clr);
+	SceneVertex br(t * (p + side * (n1 + n2)), tc, clr);
+	buildQuad(_vertices, tl, tr, bl, br);
+}
+
+/*
+ * Tessellated curve is cached, so color, shadow, width and transform changes
+ * only regenerate vertices from existing points
+ */
+void Line::buildVertices(SceneRenderer&)
+{
+	if (!_curveValid || (_curveOrigin != origin()) || (_curveSize != size()))
+		buildCurve();
+	
+	_vertices.setOffset(0);
+	
+	vec4 baseColor = finalColor();
+	vec4 texCoord(0.0f, 0.0f, 0.0f, 1.0f);
+	Transform2d tr = finalTransform();
+	
+	if (_shadowColor.w > 0.0f)
+		buildStrip(_shadowOffset, _shadowColor, _shadowColor, texCoord, tr);
+	
+	buildStrip(vec2(0.0f), baseColor * _startColor, baseColor * _endColor, texCoord, tr);
+	
 	setContentValid();
 }
 
@@ -28,7 +28,7 @@ ListboxPopup::ListboxPopup(Listbox* owner, const std::string& name) :
 
 void ListboxPopup::buildVertices(SceneRenderer&)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	_backgroundVertices.setOffset(0);
 	_textVertices.setOffset(0);
 	_selectionVertices.setOffset(0);
@@ -183,7 +183,7 @@ void Listbox::setSelectionImage(const Image& img)
 
 void Listbox::buildVertices(SceneRenderer&)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	_backgroundVertices.setOffset(0);
 	_textVertices.setOffset(0);
 
@@ -227,6 +227,14 @@ bool Listbox::containsPoint(const vec2& p, const vec2& np)
 	return Element2d::containsPoint(p, np) || inPopup;
 }
 
+bool Listbox::hitTestBounds(rect&)
+{
+	/*
+	 * Opened popup extends outside of the listbox and is reached through it
+	 */
+	return false;
+}
+
 void Listbox::didChangeFrame()
 {
 	configurePopup();
@@ -7,6 +7,7 @@
 
 #include <et/rendering/rendercontext.h>
 #include <et-ext/scene2d/scenerenderer.h>
+#include <et-ext/scene2d/vertexbuilder.h>
 #include <et-ext/scene2d/particleselement.h>
 
 using namespace et;
@@ -18,10 +19,10 @@ extern const std::string particlesFragmentShader;
 ET_DECLARE_SCENE_ELEMENT_CLASS(ParticlesElement)
 
 ParticlesElement::ParticlesElement(size_t amount, Element2d* parent, const std::string& name) :
-	s2d::Element2d(parent, ET_S2D_PASS_NAME_TO_BASE_CLASS), _particles(amount), _vertices(amount, 0)
+	s2d::Element2d(parent, ET_S2D_PASS_NAME_TO_BASE_CLASS), _particles(amount), _vertices(QuadGeometry_Vertices * amount, 0)
 {
 	setLocationInParent(s2d::Location_Center);
-	setFlag(s2d::Flag_DynamicRendering | s2d::Flag_TransparentForPointer);
+	setFlag(s2d::Flag_TransparentForPointer);
 	
 	particles::PointSprite baseParticle;
 	particles::PointSprite variationParticle;
@@ -80,8 +81,6 @@ void ParticlesElement::addToRenderQueue(RenderContext* rc, SceneRenderer& gr)
 {
 	initProgram(gr);
 	
-	rc->renderState().setPointSizeControlInVertexShader(true);
-	
 	if (_defaultTexture.invalid())
 	{
 		_defaultTexture = rc->textureFactory().genTexture(TextureTarget::Texture_2D, TextureFormat::RGBA,
@@ -95,19 +94,32 @@ void ParticlesElement::addToRenderQueue(RenderContext* rc, SceneRenderer& gr)
 	{
 		vec4 fc = finalColor();
 		
-		if (!contentValid())
+		if (!contentValid() || !transformValid())
 		{
+			/*
+			 * Particles are expanded and transformed on CPU, so they could share quad index buffer
+			 * and draw call with the rest of the scene
+			 */
+			const Transform2d& transform = finalTransform();
+			_vertices.setOffset(0);
+			_vertices.fitToSize(QuadGeometry_Vertices * _particles.activeParticlesCount());
 			for (size_t i = 0; i < _particles.activeParticlesCount(); ++i)
 			{
 				const auto& p = _particles.particle(i);
-				_vertices[i].position = vec3(p.position.xy(), p.size);
-				_vertices[i].color = fc * p.color;
+				vec2 center = p.position.xy();
+				vec2 halfSize(0.5f * p.size);
+				vec4 color = fc * p.color;
+				
+				buildQuad(_vertices,
+					SceneVertex(center - halfSize, vec4(0.0f, 0.0f, 0.0f, 0.0f), color),
+					SceneVertex(center + vec2(halfSize.x, -halfSize.y), vec4(1.0f, 0.0f, 0.0f, 0.0f), color),
+					SceneVertex(center + vec2(-halfSize.x, halfSize.y), vec4(0.0f, 1.0f, 0.0f, 0.0f), color),
+					SceneVertex(center + halfSize, vec4(1.0f, 1.0f, 0.0f, 0.0f), color), transform);
 			}
-			_vertices.setOffset(_particles.activeParticlesCount());
 			setContentValid();
 		}
 		
-		gr.addVertices(_vertices, _texture, program(), this, PrimitiveType::Points);
+		gr.addVertices(_vertices, _texture, program(), this);
 	}
 }
 
@@ -126,11 +138,6 @@ et::s2d::SceneProgram ParticlesElement::initProgram(et::s2d::SceneRenderer& r)
 	return _program;
 }
 
-void ParticlesElement::setProgramParameters(et::RenderContext*, et::Program::Pointer& p)
-{
-	p->setUniform("finalTransform", finalTransform());
-}
-
 void ParticlesElement::setTexture(const et::Texture::Pointer& t)
 {
 	_texture = t.invalid() ? _defaultTexture : t;
@@ -138,7 +145,6 @@ void ParticlesElement::setTexture(const et::Texture::Pointer& t)
 
 const std::string particlesVertexShader =
 "uniform mat4 mTransform;"
-"uniform mat4 finalTransform;"
 "uniform vec3 additionalOffsetAndAlpha;"
 
 "etVertexIn vec3 Vertex;"
@@ -150,19 +156,19 @@ const std::string particlesVertexShader =
 
 "void main()"
 "{"
-"	vec4 vTransformed = mTransform * finalTransform * vec4(Vertex.xy, 0.0, 1.0);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 "	texCoord = TexCoord0.xy;"
 "	tintColor = Color * vec4(1.0, 1.0, 1.0, additionalOffsetAndAlpha.z);"
-"	gl_PointSize = Vertex.z;"
 "	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 "}";
 
 const std::string particlesFragmentShader =
 "uniform sampler2D inputTexture;"
+"etFragmentIn etHighp vec2 texCoord;"
 "etFragmentIn etLowp vec4 tintColor;"
 "void main()"
 "{"
-"	etFragmentOut = tintColor * etTexture2D(inputTexture, gl_PointCoord);"
+"	etFragmentOut = tintColor * etTexture2D(inputTexture, texCoord);"
 "}"
 "";
 
@@ -0,0 +1,60 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/renderingelement.h>
+#include <et-ext/scene2d/renderbackend.h>
+
+using namespace et;
+using namespace et::s2d;
+
+void RecordingRenderBackend::uploadVertices(const RenderingElement* element, size_t offset, const void*, size_t size)
+{
+	Upload upload;
+	upload.element = element;
+	upload.offset = offset;
+	upload.size = size;
+	_uploads.push_back(upload);
+
+	_uploadedBytes += size;
+}
+
+void RecordingRenderBackend::drawChunk(const RenderingElement* element, const RenderChunk& chunk, size_t firstIndex,
+	const vec4*, size_t objectParametersCount)
+{
+	Draw draw;
+	draw.element = element;
+	draw.firstIndex = firstIndex;
+	draw.indexCount = chunk.count;
+	draw.clip = chunk.clip;
+	draw.texture = chunk.texture;
+	draw.program = chunk.program;
+	draw.objectParametersCount = objectParametersCount;
+	_draws.push_back(draw);
+}
+
+void RecordingRenderBackend::drawInstances(const RenderingElement* element, const RenderChunk& chunk,
+	size_t firstInstance, size_t instanceCount, const vec4*, size_t objectParametersCount)
+{
+	Draw draw;
+	draw.element = element;
+	draw.firstIndex = QuadGeometry_Indices * firstInstance;
+	draw.indexCount = chunk.count;
+	draw.firstInstance = firstInstance;
+	draw.instanceCount = instanceCount;
+	draw.clip = chunk.clip;
+	draw.texture = chunk.texture;
+	draw.program = chunk.program;
+	draw.objectParametersCount = objectParametersCount;
+	_draws.push_back(draw);
+}
+
+void RecordingRenderBackend::clear()
+{
+	_uploads.clear();
+	_draws.clear();
+	_uploadedBytes = 0;
+}
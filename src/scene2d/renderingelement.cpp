@@ -5,62 +5,312 @@
  *
  */
 
+#include <chrono>
+#include <cstring>
+#include <et/opengl/opengl.h>
 #include <et/rendering/rendercontext.h>
 #include <et-ext/scene2d/renderingelement.h>
+#include <et-ext/scene2d/vertexbuilder.h>
 
 using namespace et;
 using namespace et::s2d;
 
 #define ET_RENDER_CHUNK_USE_MAP_BUFFER	1
 
+/*
+ * In order of SceneQuadInstance members: origin, axis, texCoord, color
+ */
+static const VertexAttributeUsage instanceAttributes[] =
+{
+	VertexAttributeUsage::Position,
+	VertexAttributeUsage::TexCoord1,
+	VertexAttributeUsage::TexCoord0,
+	VertexAttributeUsage::Color,
+};
+
+/*
+ * 32-bit indices are core in desktop OpenGL and OpenGL ES 3, OpenGL ES 2 requires extension
+ */
+static bool integerIndicesSupported()
+{
+	static const bool supported = []()
+	{
+		const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+		if ((version == nullptr) || (strstr(version, "OpenGL ES 2") == nullptr))
+			return true;
+		
+		const char* extensions = reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+		return (extensions != nullptr) && (strstr(extensions, "GL_OES_element_index_uint") != nullptr);
+	}();
+	
+	return supported;
+}
+
 /*
  * Render chunk
  */
 RenderChunk::RenderChunk(size_t aFirst, size_t aCount, const recti& aClip, const Texture::Pointer& aTexture,
-	const SceneProgram& aProgram, Element2d* aObject, PrimitiveType pt) : first(aFirst), count(aCount), clip(aClip),
-	texture(aTexture), program(aProgram), object(aObject), primitiveType(pt) { }
+	const SceneProgram& aProgram, Element2d* aObject) : first(aFirst), count(aCount), clip(aClip),
+	texture(aTexture), program(aProgram), object(aObject) { }
+
+size_t RenderChunk::slotForObject(Element2d* obj)
+{
+	if ((parameterObjectsCount > 0) && (parameterObjects[parameterObjectsCount - 1] == obj))
+		return parameterObjectsCount - 1;
+	
+	if (parameterObjectsCount == ObjectParameters_MaxObjects)
+		return ObjectParameters_MaxObjects;
+	
+	parameterObjects[parameterObjectsCount] = obj;
+	return parameterObjectsCount++;
+}
+
+/*
+ * Render statistics
+ */
+void RenderStatistics::append(const RenderStatistics& s)
+{
+	chunks += s.chunks;
+	drawCalls += s.drawCalls;
+	uploadedVertices += s.uploadedVertices;
+	drawnVertices += s.drawnVertices;
+	textureSwitches += s.textureSwitches;
+	programSwitches += s.programSwitches;
+	clipSwitches += s.clipSwitches;
+	rebuiltElements += s.rebuiltElements;
+	addToRenderQueueTime += s.addToRenderQueueTime;
+	commitTime += s.commitTime;
+	renderTime += s.renderTime;
+	
+	for (const auto& t : s.rebuiltElementTypes)
+		rebuiltElementTypes[t.first] += t.second;
+}
+
+Dictionary RenderStatistics::dictionary() const
+{
+	Dictionary result;
+	result.setIntegerForKey("chunks", chunks);
+	result.setIntegerForKey("draw_calls", drawCalls);
+	result.setIntegerForKey("uploaded_vertices", uploadedVertices);
+	result.setIntegerForKey("drawn_vertices", drawnVertices);
+	result.setIntegerForKey("texture_switches", textureSwitches);
+	result.setIntegerForKey("program_switches", programSwitches);
+	result.setIntegerForKey("clip_switches", clipSwitches);
+	result.setIntegerForKey("rebuilt_elements", rebuiltElements);
+	result.setFloatForKey("add_to_render_queue_time", static_cast<float>(addToRenderQueueTime));
+	result.setFloatForKey("commit_time", static_cast<float>(commitTime));
+	result.setFloatForKey("render_time", static_cast<float>(renderTime));
+	
+	Dictionary types;
+	for (const auto& t : rebuiltElementTypes)
+		types.setIntegerForKey(t.first, t.second);
+	result.setDictionaryForKey("rebuilt_element_types", types);
+	
+	return result;
+}
+
+double RenderStatistics::currentTime()
+{
+	auto now = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration<double, std::milli>(now).count();
+}
 
 /*
  * Rendering element
  */
-RenderingElement::RenderingElement(RenderContext* rc, size_t capacity) :
-	renderState(rc->renderState())
+RenderingElement::RenderingElement(RenderContext* rc, size_t capacity, StreamingMode mode, VertexFormat format,
+	const RenderBackend::Pointer& backend) : _rc(rc), _backend(backend), _streamingMode(mode), _vertexFormat(format)
 {
-	auto indexArray = IndexArray::Pointer::create(IndexArrayFormat::Format_16bit, capacity, PrimitiveType::Triangles);
-	indexArray->linearize(capacity);
+	ET_ASSERT((rc != nullptr) || backend.valid());
+	
+	if (rc != nullptr)
+		renderState = &rc->renderState();
+	
+	/*
+	 * Instances share single quad, so they are always drawn with 16-bit indices
+	 */
+	bool shortIndicesOnly = (rc != nullptr) && (format != VertexFormat::Instanced) && !integerIndicesSupported();
+	_maxCapacity = shortIndicesOnly ? MaxShortIndexCapacity : std::numeric_limits<size_t>::max();
 	
-	VertexDeclaration decl(true, VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec4);
-	decl.push_back(VertexAttributeUsage::Color, VertexAttributeType::Vec4);
-	decl.push_back(VertexAttributeUsage::Position, VertexAttributeType::Vec3);
-	dataSize = decl.dataSize() * capacity;
+	createBuffers(etMin(capacity, _maxCapacity));
+}
+
+void RenderingElement::createBuffers(size_t capacity)
+{
+	ET_ASSERT((capacity > 0) && (capacity % QuadGeometry_Vertices == 0));
 	
 #if (ET_RENDER_CHUNK_USE_MAP_BUFFER == 0)
-	vertexData = sharedBlockAllocator().alloc(dataSize);
+	if ((_streamingMode == StreamingMode::TripleBuffer) && _backend.invalid() && (vertexData != nullptr))
+		sharedBlockAllocator().free(vertexData);
 #endif
 	
+	_capacity = capacity;
+	
+	bool instanced = (_vertexFormat == VertexFormat::Instanced);
+	
+	VertexDeclaration decl(true);
+	if (instanced)
+	{
+		for (auto usage : instanceAttributes)
+			decl.push_back(usage, VertexAttributeType::Vec4);
+		ET_ASSERT(decl.dataSize() == sizeof(SceneQuadInstance));
+	}
+	else if (_vertexFormat == VertexFormat::Packed)
+	{
+		decl.push_back(VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+		decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec4);
+		ET_ASSERT(decl.dataSize() == sizeof(PackedSceneVertex));
+	}
+	else
+	{
+		decl.push_back(VertexAttributeUsage::TexCoord0, VertexAttributeType::Vec4);
+		decl.push_back(VertexAttributeUsage::Color, VertexAttributeType::Vec4);
+		decl.push_back(VertexAttributeUsage::Position, VertexAttributeType::Vec3);
+		ET_ASSERT(decl.dataSize() == sizeof(SceneVertex));
+	}
+	
+	/*
+	 * Ranges are still counted in vertices, so instance is spread over vertices of its quad
+	 */
+	_vertexSize = instanced ? decl.dataSize() / QuadGeometry_Vertices : decl.dataSize();
+	dataSize = _vertexSize * capacity;
+	
+	_ringWriteOffset = 0;
+	_committedVertices = 0;
+	_baseVertex = 0;
+	currentBufferIndex = 0;
+	
+	if (_backend.valid())
+	{
+		/*
+		 * Without GPU buffers vertices are kept in the staging storage in every mode
+		 */
+		_stagingData.resize(dataSize);
+		vertexData = _stagingData.data();
+		return;
+	}
+	
+	/*
+	 * Instances share single quad, which is also the only one stored in the vertex array
+	 */
+	size_t numQuads = instanced ? 1 : capacity / QuadGeometry_Vertices;
+	size_t numElements = instanced ? capacity / QuadGeometry_Vertices : capacity;
+	auto indexFormat = (capacity > MaxShortIndexCapacity) && !instanced ?
+		IndexArrayFormat::Format_32bit : IndexArrayFormat::Format_16bit;
+	auto indexArray = IndexArray::Pointer::create(indexFormat, QuadGeometry_Indices * numQuads, PrimitiveType::Triangles);
+	
+	size_t indexPos = 0;
+	for (size_t q = 0; q < numQuads; ++q)
+	{
+		IndexType base = static_cast<IndexType>(QuadGeometry_Vertices * q);
+		indexArray->setIndex(base + 0, indexPos++);
+		indexArray->setIndex(base + 1, indexPos++);
+		indexArray->setIndex(base + 2, indexPos++);
+		indexArray->setIndex(base + 0, indexPos++);
+		indexArray->setIndex(base + 2, indexPos++);
+		indexArray->setIndex(base + 3, indexPos++);
+	}
+	
 	IndexBuffer::Pointer sharedIndexBuffer;
-	VertexArray::Pointer sharedVertexArray = VertexArray::Pointer::create(decl, capacity);
+	VertexArray::Pointer sharedVertexArray = VertexArray::Pointer::create(decl, numElements);
 	
 	auto nameId = intToStr(reinterpret_cast<size_t>(this)) + "-vao-1";
-	vertices[0] = rc->vertexBufferFactory().createVertexArrayObject(nameId,
+	vertices[0] = _rc->vertexBufferFactory().createVertexArrayObject(nameId,
 		sharedVertexArray, BufferDrawType::Stream, indexArray, BufferDrawType::Static);
 	sharedIndexBuffer = vertices[0]->indexBuffer();
 	
-	for (size_t i = 1; i < VertexBuffersCount; ++i)
+	if (_streamingMode != StreamingMode::TripleBuffer)
 	{
-		nameId = intToStr(reinterpret_cast<size_t>(this)) + "-vao-" + intToStr(i + 1);
-		vertices[i] = rc->vertexBufferFactory().createVertexArrayObject(nameId);
-		auto vb = rc->vertexBufferFactory().createVertexBuffer(nameId + "-vb",
-			sharedVertexArray, BufferDrawType::Stream);
-		vertices[i]->setBuffers(vb, sharedIndexBuffer);
+		/*
+		 * Ring buffer and persistent modes use single vertex buffer,
+		 * vertices are written to the staging storage and only written ranges gets uploaded
+		 */
+		_stagingData.resize(dataSize);
+		vertexData = _stagingData.data();
+	}
+	else
+	{
+#	if (ET_RENDER_CHUNK_USE_MAP_BUFFER == 0)
+		vertexData = sharedBlockAllocator().alloc(dataSize);
+#	endif
+		
+		for (size_t i = 1; i < VertexBuffersCount; ++i)
+		{
+			nameId = intToStr(reinterpret_cast<size_t>(this)) + "-vao-" + intToStr(i + 1);
+			vertices[i] = _rc->vertexBufferFactory().createVertexArrayObject(nameId);
+			auto vb = _rc->vertexBufferFactory().createVertexBuffer(nameId + "-vb",
+				sharedVertexArray, BufferDrawType::Stream);
+			vertices[i]->setBuffers(vb, sharedIndexBuffer);
+		}
+	}
+	
+	if (instanced)
+	{
+		for (const auto& vao : vertices)
+		{
+			if (vao.valid())
+				enableInstancing(vao);
+		}
 	}
-	currentBufferIndex = 0;
+}
+
+void RenderingElement::enableInstancing(const VertexArrayObject& vao)
+{
+	renderState->bindVertexArray(vao);
+	
+	/*
+	 * Render state has no divisors, they are set for the same attributes
+	 * render state points for the declaration of the vertex buffer
+	 */
+	for (const auto& e : vao->vertexBuffer()->declaration().elements())
+		glVertexAttribDivisor(static_cast<GLuint>(e.usage()), 1);
+}
+
+void RenderingElement::setFirstInstance(size_t firstInstance)
+{
+	ET_ASSERT(_vertexFormat == VertexFormat::Instanced);
+	
+	const auto& vb = vertices[currentBufferIndex]->vertexBuffer();
+	renderState->bindBuffer(vb);
+	renderState->setVertexAttributesBaseIndex(vb->declaration(), firstInstance);
+}
+
+void RenderingElement::growIfNeeded()
+{
+	if (!_overflow || (_reservedVertices <= _capacity))
+		return;
+	
+	if (_capacity >= _maxCapacity)
+	{
+		if (!_maxCapacityReported)
+		{
+			log::warning("Unable to grow rendering element over %llu vertices without 32-bit indices.",
+				static_cast<uint64_t>(_maxCapacity));
+			_maxCapacityReported = true;
+		}
+		return;
+	}
+	
+	/*
+	 * Grow with some reserve, so the next few builds would not overflow again
+	 */
+	size_t newCapacity = etMax(2 * _capacity, _reservedVertices + _reservedVertices / 4);
+	newCapacity = QuadGeometry_Vertices * ((newCapacity + QuadGeometry_Vertices - 1) / QuadGeometry_Vertices);
+	newCapacity = etMin(newCapacity, _maxCapacity);
+	
+	_persistentRanges.clear();
+	_dirtyRanges.clear();
+	_persistentEnd = 0;
+	_persistentLiveVertices = 0;
+	
+	createBuffers(newCapacity);
 }
 
 RenderingElement::~RenderingElement()
 {
 #if (ET_RENDER_CHUNK_USE_MAP_BUFFER == 0)
-	sharedBlockAllocator().free(vertexData);
+	if ((_streamingMode == StreamingMode::TripleBuffer) && _backend.invalid())
+		sharedBlockAllocator().free(vertexData);
 #endif
 }
 
@@ -72,43 +322,350 @@ void RenderingElement::clear()
 
 void RenderingElement::startAllocatingVertices()
 {
-	currentBufferIndex = (currentBufferIndex + 1) % VertexBuffersCount;
 	clear();
+	growIfNeeded();
+	
+	bool overflow = _overflow;
+	_overflow = false;
+	_requestedVertices = 0;
+	_reservedVertices = 0;
+	
+	if (_streamingMode == StreamingMode::Persistent)
+	{
+		++_buildIndex;
+		
+		/*
+		 * Start from scratch if storage overflowed or became too fragmented
+		 */
+		bool fragmented = (_persistentEnd > _capacity / 2) && (2 * _persistentLiveVertices < _persistentEnd);
+		if (overflow || fragmented)
+		{
+			_persistentRanges.clear();
+			_dirtyRanges.clear();
+			_persistentEnd = 0;
+		}
+		return;
+	}
+	
+	if (_streamingMode == StreamingMode::RingBuffer)
+		return;
+	
+	currentBufferIndex = (currentBufferIndex + 1) % VertexBuffersCount;
+	
+	if (_backend.valid())
+		return;
 	
 #if (ET_RENDER_CHUNK_USE_MAP_BUFFER)
-	renderState.bindVertexArray(vertices[currentBufferIndex]);
+	renderState->bindVertexArray(vertices[currentBufferIndex]);
 	vertexData = vertices[currentBufferIndex]->vertexBuffer()->map(0, dataSize,
 		MapBufferOptions::Write | MapBufferOptions::InvalidateRange);
 #endif
 }
 
-SceneVertex* RenderingElement::allocateVertices(size_t n)
+RenderingElement::VertexRange RenderingElement::allocateVertices(const SceneVertexList& list, size_t n,
+	const Element2d* owner, bool transient)
 {
-	auto result = mappedVertices + allocatedVertices;
+	ET_ASSERT(n % QuadGeometry_Vertices == 0);
+	
+	_requestedVertices += n;
+	
+	if (_streamingMode == StreamingMode::Persistent)
+		return allocatePersistentVertices(list, n, owner, transient);
+	
+	_reservedVertices += n;
+	if (allocatedVertices + n > _capacity)
+	{
+		_overflow = true;
+		return VertexRange(0, 0);
+	}
+	
+	VertexRange result(allocatedVertices, n);
 	allocatedVertices += n;
 	return result;
 }
 
-void RenderingElement::commitAllocatedVertices()
+void RenderingElement::writeVertices(const SceneVertexList& list, const SceneVertexList& source,
+	const VertexRange& range, size_t objectSlot)
+{
+	ET_ASSERT(objectSlot < ObjectParameters_MaxObjects);
+	
+	if (_streamingMode == StreamingMode::Persistent)
+		writePersistentVertices(list, source, objectSlot);
+	else
+		copyVertices(source, range.first, range.count, objectSlot);
+}
+
+void RenderingElement::copyVertices(const SceneVertexList& list, size_t first, size_t count, size_t objectSlot)
+{
+	float slot = static_cast<float>(objectSlot);
+	
+	if (_vertexFormat == VertexFormat::Instanced)
+	{
+		auto target = reinterpret_cast<SceneQuadInstance*>(vertexData) + first / QuadGeometry_Vertices;
+		for (size_t i = 0; i < count; i += QuadGeometry_Vertices, ++target)
+		{
+			packSceneQuad(list.data() + i, *target);
+			target->axis.w += slot;
+		}
+	}
+	else if (_vertexFormat == VertexFormat::Packed)
+	{
+		/*
+		 * Slot is stored above red and green components of the packed color
+		 */
+		float slotOffset = 65536.0f * slot;
+		auto target = reinterpret_cast<PackedSceneVertex*>(vertexData) + first;
+		for (size_t i = 0; i < count; ++i, ++target)
+		{
+			packSceneVertex(list[i], *target);
+			target->texCoord.z += slotOffset;
+		}
+	}
+	else
+	{
+		auto target = reinterpret_cast<SceneVertex*>(vertexData) + first;
+		etCopyMemory(target, list.data(), count * sizeof(SceneVertex));
+		for (size_t i = 0; i < count; ++i)
+			target[i].position.z = slot;
+	}
+}
+
+bool RenderingElement::commitAllocatedVertices()
 {
+	_highWaterMark = etMax(_highWaterMark, _requestedVertices);
+	_uploadedVertices = 0;
+	
+	if (_streamingMode == StreamingMode::Persistent)
+		return commitPersistentVertices();
+	
+	if (_streamingMode == StreamingMode::RingBuffer)
+	{
+		if (_overflow)
+			return false;
+		
+		commitToRingBuffer();
+		return true;
+	}
+	
+	_uploadedVertices = allocatedVertices;
+	
+	if (_backend.valid())
+	{
+		_backend->uploadVertices(this, 0, vertexData, _vertexSize * allocatedVertices);
+		return !_overflow;
+	}
+	
 	auto vao = vertices[currentBufferIndex];
-	renderState.bindVertexArray(vao);
+	renderState->bindVertexArray(vao);
 	
 #if (ET_RENDER_CHUNK_USE_MAP_BUFFER)
 	vao->vertexBuffer()->unmap();
 #else
-	vao->vertexBuffer()->setData(vertexData, sizeof(SceneVertex) * allocatedVertices);
+	vao->vertexBuffer()->setData(vertexData, _vertexSize * allocatedVertices);
 #endif
+	
+	return !_overflow;
+}
+
+void RenderingElement::commitToRingBuffer()
+{
+	ET_ASSERT(allocatedVertices <= _capacity);
+	
+	_committedVertices = allocatedVertices;
+	if (_committedVertices == 0)
+		return;
+	
+	/*
+	 * Regions written since the latest orphaning are never overwritten, so appended
+	 * region could be mapped without synchronization. When the end is reached
+	 * whole storage is orphaned, GPU keeps reading the old one and nothing waits.
+	 */
+	auto mapOptions = MapBufferOptions::Write | MapBufferOptions::InvalidateRange | MapBufferOptions::Unsynchronized;
+	if (_ringWriteOffset + _committedVertices > _capacity)
+	{
+		_ringWriteOffset = 0;
+		mapOptions = MapBufferOptions::Write | MapBufferOptions::InvalidateBuffer;
+	}
+	
+	size_t bytesToWrite = _vertexSize * _committedVertices;
+	
+	if (_backend.valid())
+	{
+		_backend->uploadVertices(this, _vertexSize * _ringWriteOffset, _stagingData.data(), bytesToWrite);
+	}
+	else
+	{
+		auto vao = vertices[0];
+		renderState->bindVertexArray(vao);
+		void* target = vao->vertexBuffer()->map(_vertexSize * _ringWriteOffset, bytesToWrite, mapOptions);
+		etCopyMemory(target, _stagingData.data(), bytesToWrite);
+		vao->vertexBuffer()->unmap();
+	}
+	
+	_baseVertex = _ringWriteOffset;
+	_ringWriteOffset += _committedVertices;
+	_uploadedVertices = _committedVertices;
+}
+
+RenderingElement::VertexRange RenderingElement::allocatePersistentVertices(const SceneVertexList& list,
+	size_t n, const Element2d* owner, bool transient)
+{
+	size_t version = (owner == nullptr) ? 0 : owner->contentVersion();
+	
+	auto& range = _persistentRanges[&list];
+	bool knownRange = (range.capacity > 0) && (range.owner == owner);
+	bool reusable = !transient && !range.transient;
+	
+	range.buildIndex = _buildIndex;
+	range.transient = transient;
+	if (knownRange && reusable && (owner != nullptr) && (range.version == version) && (range.count == n))
+	{
+		_reservedVertices += range.capacity;
+		allocatedVertices += range.capacity;
+		return VertexRange(range.first, range.capacity);
+	}
+	
+	range.valid = false;
+	if (knownRange && (n <= range.capacity))
+	{
+		_reservedVertices += range.capacity;
+	}
+	else
+	{
+		/*
+		 * Reserve some space for the list to grow without moving it,
+		 * storage grows to fit ranges with reserve, not just requested vertices
+		 */
+		size_t capacity = n + QuadGeometry_Vertices * (1 + n / (4 * QuadGeometry_Vertices));
+		_reservedVertices += capacity;
+		
+		if (_persistentEnd + capacity > _capacity)
+			capacity = n;
+		
+		if (_persistentEnd + capacity > _capacity)
+		{
+			_overflow = true;
+			_persistentRanges.erase(&list);
+			return VertexRange(0, 0);
+		}
+		
+		range.first = _persistentEnd;
+		range.capacity = capacity;
+		_persistentEnd += capacity;
+	}
+	
+	range.owner = owner;
+	range.version = version;
+	range.count = n;
+	
+	allocatedVertices += range.capacity;
+	return VertexRange(range.first, range.capacity);
+}
+
+void RenderingElement::writePersistentVertices(const SceneVertexList& list, const SceneVertexList& source,
+	size_t objectSlot)
+{
+	auto i = _persistentRanges.find(&list);
+	if (i == _persistentRanges.end())
+		return;
+	
+	auto& range = i->second;
+	if (range.valid && (range.objectSlot == objectSlot))
+		return;
+	
+	range.objectSlot = objectSlot;
+	range.valid = true;
+	
+	/*
+	 * Unused tail of the range is filled with degenerate quads,
+	 * so the whole range could be drawn together with neighbours
+	 */
+	copyVertices(source, range.first, range.count, objectSlot);
+	if (range.capacity > range.count)
+	{
+		etFillMemory(static_cast<char*>(vertexData) + _vertexSize * (range.first + range.count), 0,
+			_vertexSize * (range.capacity - range.count));
+	}
+	
+	_dirtyRanges.emplace_back(range.first, range.capacity);
+}
+
+bool RenderingElement::commitPersistentVertices()
+{
+	if (_overflow)
+	{
+		_dirtyRanges.clear();
+		return false;
+	}
+	
+	_persistentLiveVertices = 0;
+	for (auto i = _persistentRanges.begin(); i != _persistentRanges.end(); )
+	{
+		if (i->second.buildIndex == _buildIndex)
+		{
+			_persistentLiveVertices += i->second.capacity;
+			++i;
+		}
+		else
+		{
+			i = _persistentRanges.erase(i);
+		}
+	}
+	
+	if (_dirtyRanges.empty())
+		return true;
+	
+	std::sort(_dirtyRanges.begin(), _dirtyRanges.end(), [](const VertexRange& l, const VertexRange& r)
+		{ return l.first < r.first; });
+	
+	auto vao = vertices[0];
+	if (_backend.invalid())
+		renderState->bindVertexArray(vao);
+	
+	size_t i = 0;
+	while (i < _dirtyRanges.size())
+	{
+		size_t first = _dirtyRanges[i].first;
+		size_t last = first + _dirtyRanges[i].count;
+		while ((++i < _dirtyRanges.size()) && (_dirtyRanges[i].first <= last))
+			last = etMax(last, _dirtyRanges[i].first + _dirtyRanges[i].count);
+		
+		size_t offset = _vertexSize * first;
+		size_t bytesToWrite = _vertexSize * (last - first);
+		if (_backend.valid())
+		{
+			_backend->uploadVertices(this, offset, _stagingData.binary() + offset, bytesToWrite);
+		}
+		else
+		{
+			void* target = vao->vertexBuffer()->map(offset, bytesToWrite,
+				MapBufferOptions::Write | MapBufferOptions::InvalidateRange);
+			etCopyMemory(target, _stagingData.binary() + offset, bytesToWrite);
+			vao->vertexBuffer()->unmap();
+		}
+		
+		_uploadedVertices += last - first;
+	}
+	
+	_dirtyRanges.clear();
+	return true;
 }
 
 const VertexArrayObject& RenderingElement::vertexArrayObject()
 {
 	const auto& vao = vertices[currentBufferIndex];
-	renderState.bindVertexArray(vao);
 	
-#if (ET_RENDER_CHUNK_USE_MAP_BUFFER)
-	ET_ASSERT(!vertices[currentBufferIndex]->vertexBuffer()->mapped());
-#endif
+	/*
+	 * Without GPU buffers returned object is empty
+	 */
+	if (_backend.invalid())
+	{
+		renderState->bindVertexArray(vao);
+		
+#	if (ET_RENDER_CHUNK_USE_MAP_BUFFER)
+		ET_ASSERT(!vertices[currentBufferIndex]->vertexBuffer()->mapped());
+#	endif
+	}
 	
 	return vao;
 }
@@ -6,6 +6,7 @@
  */
 
 #include <et/app/application.h>
+#include <et/json/json.h>
 #include <et-ext/scene2d/scene.h>
 
 using namespace et;
@@ -15,6 +16,20 @@ Scene::Scene(RenderContext* rc) : _rc(rc),
 	_renderer(rc), _renderingElementBackground(sharedObjectFactory().createObject<RenderingElement>(rc, 256)),
 	_renderingElementOverlay(sharedObjectFactory().createObject<RenderingElement>(rc, 256)),
 	_background(Image(), nullptr), _overlay(Image(), nullptr)
+{
+	init(rc->size());
+}
+
+Scene::Scene(const vec2& size, const RenderBackend::Pointer& backend) : _rc(nullptr),
+	_renderer(nullptr, size), _background(Image(), nullptr), _overlay(Image(), nullptr)
+{
+	ET_ASSERT(backend.valid());
+	
+	setRenderBackend(backend);
+	init(size);
+}
+
+void Scene::init(const vec2& size)
 {
 	_background.setPivotPoint(vec2(0.5f));
 	_background.setContentMode(ImageView::ContentMode_Fill);
@@ -22,7 +37,7 @@ Scene::Scene(RenderContext* rc) : _rc(rc),
 	_overlay.setPivotPoint(vec2(0.5f));
 	_overlay.setContentMode(ImageView::ContentMode_Fill);
 	
-	layout(rc->size());
+	layout(size);
 }
 
 bool Scene::pointerPressed(const et::PointerInputInfo& p)
@@ -133,11 +148,7 @@ void Scene::buildLayoutVertices(RenderContext* rc, RenderingElement::Pointer ele
 	_renderer.setRendernigElement(element);
 	
 	if (!layout->valid())
-	{
-		element->startAllocatingVertices();
-		layout->addToRenderQueue(rc, _renderer);
-		element->commitAllocatedVertices();
-	}
+		buildElementVertices(rc, element, *layout.ptr());
 }
 
 void Scene::buildBackgroundVertices(RenderContext* rc)
@@ -145,11 +156,7 @@ void Scene::buildBackgroundVertices(RenderContext* rc)
 	_renderer.setRendernigElement(_renderingElementBackground);
 	
 	if (!_background.contentValid())
-	{
-		_renderingElementBackground->startAllocatingVertices();
-		_background.addToRenderQueue(rc, _renderer);
-		_renderingElementBackground->commitAllocatedVertices();
-	}
+		buildElementVertices(rc, _renderingElementBackground, _background);
 }
 
 void Scene::buildOverlayVertices(RenderContext* rc)
@@ -157,16 +164,124 @@ void Scene::buildOverlayVertices(RenderContext* rc)
 	_renderer.setRendernigElement(_renderingElementOverlay);
 	
 	if (!_overlay.contentValid())
+		buildElementVertices(rc, _renderingElementOverlay, _overlay);
+}
+
+void Scene::buildElementVertices(RenderContext* rc, RenderingElement::Pointer& element, Element2d& source)
+{
+	auto& stats = _renderer.statistics();
+	bool collectStats = _renderer.statisticsEnabled();
+	
+	if (_renderer.damageTrackingEnabled())
+		_renderer.startTrackingDamage();
+	
+	double t0 = collectStats ? RenderStatistics::currentTime() : 0.0;
+	element->startAllocatingVertices();
+	source.addToRenderQueue(rc, _renderer);
+	
+	double t1 = collectStats ? RenderStatistics::currentTime() : 0.0;
+	bool committed = element->commitAllocatedVertices();
+	
+	double t2 = collectStats ? RenderStatistics::currentTime() : 0.0;
+	stats.uploadedVertices += collectStats ? element->uploadedVertices() : 0;
+	
+	/*
+	 * Vertex storage ran out of space, it grows on the next start, so build again from scratch
+	 * until everything fits. If storage could not grow anymore source stays invalid.
+	 */
+	bool succeeded = committed;
+	while (!succeeded)
 	{
-		_renderingElementOverlay->startAllocatingVertices();
-		_overlay.addToRenderQueue(rc, _renderer);
-		_renderingElementOverlay->commitAllocatedVertices();
+		size_t capacity = element->capacity();
+		element->startAllocatingVertices();
+		source.addToRenderQueue(rc, _renderer);
+		succeeded = element->commitAllocatedVertices();
+		stats.uploadedVertices += collectStats ? element->uploadedVertices() : 0;
+		
+		if (!succeeded && (element->capacity() == capacity))
+		{
+			log::error("Unable to fit vertices of %s into %llu vertices.", source.name().c_str(),
+				static_cast<uint64_t>(capacity));
+			source.invalidateContent();
+			break;
+		}
 	}
+	
+	if (_renderer.damageTrackingEnabled())
+		_renderer.finishTrackingDamage();
+	
+	if (collectStats)
+	{
+		double t3 = RenderStatistics::currentTime();
+		stats.addToRenderQueueTime += t1 - t0;
+		stats.commitTime += t2 - t1;
+		
+		if (!committed)
+			stats.addToRenderQueueTime += t3 - t2;
+	}
+}
+
+void Scene::collectStatistics(RenderStatistics* layoutStatistics)
+{
+	if (!_renderer.statisticsEnabled()) return;
+	
+	if (layoutStatistics != nullptr)
+		*layoutStatistics = _renderer.statistics();
+	
+	_frameStatistics.append(_renderer.statistics());
+	_renderer.resetStatistics();
+}
+
+void Scene::setStatisticsEnabled(bool enabled)
+{
+	_renderer.setStatisticsEnabled(enabled);
+	_renderer.resetStatistics();
+	_frameStatistics = RenderStatistics();
+}
+
+void Scene::setRenderBackend(const RenderBackend::Pointer& backend)
+{
+	ET_ASSERT(_layouts.empty() && "Render backend should be set before layouts are added to the scene");
+	
+	_renderer.setRenderBackend(backend);
+	
+	_renderingElementBackground = sharedObjectFactory().createObject<RenderingElement>(_rc, 256,
+		RenderingElement::StreamingMode::TripleBuffer, RenderingElement::VertexFormat::Default, backend);
+	
+	_renderingElementOverlay = sharedObjectFactory().createObject<RenderingElement>(_rc, 256,
+		RenderingElement::StreamingMode::TripleBuffer, RenderingElement::VertexFormat::Default, backend);
+	
+	_background.invalidateContent();
+	_overlay.invalidateContent();
+}
+
+RenderStatistics Scene::layoutStatistics(Layout::Pointer l)
+{
+	LayoutEntry* entry = entryForLayout(l);
+	return (entry == nullptr) ? RenderStatistics() : entry->statistics;
+}
+
+Dictionary Scene::statisticsDictionary() const
+{
+	Dictionary layouts;
+	for (const auto& entry : _layouts)
+		layouts.setDictionaryForKey(entry->layout->name(), entry->statistics.dictionary());
+	
+	Dictionary result;
+	result.setDictionaryForKey("frame", _frameStatistics.dictionary());
+	result.setDictionaryForKey("layouts", layouts);
+	return result;
+}
+
+std::string Scene::statisticsJSON() const
+{
+	return json::serialize(statisticsDictionary(), json::SerializationFlag_ReadableFormat);
 }
 
 void Scene::layout(const vec2& size, float duration)
 {
 	_screenSize = size;
+	_renderer.setWindowSize(size);
 	_renderer.setProjectionMatrices(size);
 	
 	_background.setPosition(0.5f * size);
@@ -177,16 +292,116 @@ void Scene::layout(const vec2& size, float duration)
 	
 	for (auto& i : _layouts)
 		i->layout->autoLayout(size, duration);
+	
+	_renderRequested = true;
 }
 
-void Scene::render(RenderContext* rc)
+/*
+ * Elements requiring pre-rendering are collected only when hierarchy,
+ * flags or set of layouts are changed, each frame just filters visible ones
+ */
+void Scene::updatePreRenderRegistry()
 {
-	_prerenderElements.clear();
+	bool layoutsChanged = (_preRenderRegistryLayouts.size() != _layouts.size());
+	
+	if (!layoutsChanged)
+	{
+		auto registeredLayout = _preRenderRegistryLayouts.begin();
+		for (auto& obj : _layouts)
+		{
+			if (*registeredLayout++ != obj->layout.ptr())
+			{
+				layoutsChanged = true;
+				break;
+			}
+		}
+	}
+	
+	if (!layoutsChanged && (_preRenderRegistryHierarchyVersion == Element2d::hierarchyVersion()) &&
+		(_preRenderRegistryFlagsVersion == Element2d::flagsVersion())) return;
+	
+	_preRenderRegistry.clear();
+	_preRenderRegistryLayouts.clear();
+	_cachedLayers.clear();
+	
+	for (auto& obj : _layouts)
+	{
+		_preRenderRegistryLayouts.push_back(obj->layout.ptr());
+		obj->layout->collectPreRenderingObjects(_preRenderRegistry, _cachedLayers);
+	}
+	
+	_preRenderRegistryHierarchyVersion = Element2d::hierarchyVersion();
+	_preRenderRegistryFlagsVersion = Element2d::flagsVersion();
+}
+
+void Scene::setRenderOnDemand(bool enabled)
+{
+	_renderOnDemand = enabled;
+	_renderRequested = true;
+}
+
+bool Scene::needsRendering()
+{
+	if (_renderRequested || animatingTransition() || (AnimationSystem::instance().activeAnimationsCount() > 0))
+		return true;
+	
+	if (_background.texture().valid() && !_background.contentValid())
+		return true;
+	
+	if (_overlay.texture().valid() && !_overlay.contentValid())
+		return true;
 	
 	for (auto& obj : _layouts)
-		obj->layout->collectPreRenderingObjects(obj->layout, _prerenderElements);
+	{
+		if (obj->layout->visible() && !obj->layout->valid())
+			return true;
+	}
+	
+	/*
+	 * Pre-rendering elements invalidate themselves when their content changes
+	 */
+	updatePreRenderRegistry();
+	for (auto e : _preRenderRegistry)
+	{
+		if (e->visible() && !e->contentValid())
+			return true;
+	}
+	
+	return false;
+}
 
-	if (!_prerenderElements.empty())
+void Scene::render(RenderContext* rc)
+{
+	if (_renderOnDemand && !needsRendering())
+	{
+		/*
+		 * Retained target still contains the last frame, so it is presented as is
+		 */
+		if (_retainedRendering && _retainedFramebuffer.valid() && (_retainedFramebuffer->size() == rc->sizei()))
+		{
+			_renderer.beginRender(rc);
+			presentRetainedFramebuffer(rc);
+			_renderer.endRender(rc);
+		}
+		return;
+	}
+	
+	bool renderRequested = _renderRequested;
+	
+	_renderRequested = false;
+	updatePreRenderRegistry();
+	
+	_prerenderElements.clear();
+	for (auto e : _preRenderRegistry)
+	{
+		if (e->visible())
+			_prerenderElements.push_back(e);
+	}
+
+	/*
+	 * Pre-rendering elements and cached layers draw through render context directly
+	 */
+	if (!_prerenderElements.empty() && (rc != nullptr))
 	{
 		auto currentBuffer = rc->renderState().boundFramebuffer();
 		auto viewportSize = rc->renderState().viewportSize();
@@ -198,13 +413,37 @@ void Scene::render(RenderContext* rc)
 		rc->renderState().setViewportSize(viewportSize);
 	}
 	
+	/*
+	 * Nested layers are collected after their parents, so they are rendered first
+	 */
+	bool projectionChanged = false;
+	if (_renderer.renderBackend().invalid())
+	{
+		for (auto i = _cachedLayers.rbegin(), e = _cachedLayers.rend(); i != e; ++i)
+		{
+			if ((*i)->visible())
+				projectionChanged |= static_cast<CachedLayer*>(*i)->renderLayer(rc, _renderer);
+		}
+	}
+	
+	if (projectionChanged)
+		_renderer.setProjectionMatrices(_screenSize);
+	
+	if (_retainedRendering)
+	{
+		renderRetained(rc, renderRequested);
+		return;
+	}
+	
 	_renderer.beginRender(rc);
+	_frameStatistics = RenderStatistics();
 
 	if (_background.texture().valid())
 	{
 		_renderer.setAdditionalOffsetAndAlpha(vec3(0.0f, 0.0f, 1.0f));
 		buildBackgroundVertices(rc);
 		_renderer.render(rc);
+		collectStatistics(nullptr);
 	}
 
 	for (auto& obj : _layouts)
@@ -214,6 +453,7 @@ void Scene::render(RenderContext* rc)
 			_renderer.setAdditionalOffsetAndAlpha(obj->offsetAlpha);
 			buildLayoutVertices(rc, obj->layout->renderingElement(), obj->layout);
 			_renderer.render(rc);
+			collectStatistics(&obj->statistics);
 		}
 	}
 	
@@ -222,11 +462,191 @@ void Scene::render(RenderContext* rc)
 		_renderer.setAdditionalOffsetAndAlpha(vec3(0.0f, 0.0f, 1.0f));
 		buildOverlayVertices(rc);
 		_renderer.render(rc);
+		collectStatistics(nullptr);
+	}
+	
+	if (_renderer.statisticsEnabled())
+		_renderer.finishStatisticsFrame();
+	
+	_renderer.endRender(rc);
+}
+
+void Scene::setRetainedRendering(bool enabled)
+{
+	if (enabled && _renderer.renderBackend().valid())
+	{
+		log::warning("Retained rendering is not supported with render backend.");
+		return;
+	}
+	
+	_retainedRendering = enabled;
+	_renderer.setDamageTrackingEnabled(enabled);
+	
+	if (!enabled)
+		_retainedFramebuffer.reset(nullptr);
+	
+	/*
+	 * Chunks get their bounds only when built with damage tracking
+	 */
+	for (auto& obj : _layouts)
+		obj->layout->invalidateContent();
+	
+	_background.invalidateContent();
+	_overlay.invalidateContent();
+	_renderRequested = true;
+}
+
+bool Scene::validateRetainedFramebuffer(RenderContext* rc)
+{
+	if (_retainedFramebuffer.valid() && (_retainedFramebuffer->size() == rc->sizei()))
+		return false;
+	
+	_retainedFramebuffer = rc->framebufferFactory().createFramebuffer(rc->sizei(), "s2d-retained-buffer",
+		TextureFormat::RGBA, TextureFormat::RGBA, DataType::UnsignedChar, TextureFormat::Invalid);
+	
+	return true;
+}
+
+bool Scene::visibleLayoutsChanged()
+{
+	size_t index = 0;
+	bool changed = false;
+	
+	for (auto& obj : _layouts)
+	{
+		if (!obj->layout->visible()) continue;
+		
+		if ((index < _retainedVisibleLayouts.size()) && (_retainedVisibleLayouts[index] == obj->layout.ptr()))
+		{
+			++index;
+			continue;
+		}
+		
+		changed = true;
+		_retainedVisibleLayouts.resize(index);
+		_retainedVisibleLayouts.push_back(obj->layout.ptr());
+		++index;
+	}
+	
+	changed |= (index != _retainedVisibleLayouts.size());
+	_retainedVisibleLayouts.resize(index);
+	return changed;
+}
+
+/*
+ * Vertices of all layouts are built first, so damage is known before anything is drawn.
+ * Only chunks intersecting damage are drawn into retained target, scissored to it.
+ */
+void Scene::renderRetained(RenderContext* rc, bool fullDamage)
+{
+	auto& rs = rc->renderState();
+	
+	fullDamage |= validateRetainedFramebuffer(rc);
+	fullDamage |= visibleLayoutsChanged();
+	fullDamage |= animatingTransition() || (_retainedHierarchyVersion != Element2d::hierarchyVersion());
+	_retainedHierarchyVersion = Element2d::hierarchyVersion();
+	
+	_renderer.beginRender(rc);
+	_frameStatistics = RenderStatistics();
+	
+	_renderer.resetDamage();
+	if (fullDamage)
+		_renderer.addFullDamage();
+	
+	for (auto e : _prerenderElements)
+	{
+		rect bounds;
+		if (e->hitTestBounds(bounds))
+			_renderer.addDamage(bounds);
+		else
+			_renderer.addFullDamage();
+	}
+	
+	bool drawBackground = _background.texture().valid();
+	bool drawOverlay = _overlay.texture().valid();
+	
+	if (drawBackground)
+	{
+		buildBackgroundVertices(rc);
+		_renderer.addDynamicChunksDamage();
+		collectStatistics(nullptr);
+	}
+	
+	for (auto& obj : _layouts)
+	{
+		if (obj->layout->visible())
+		{
+			buildLayoutVertices(rc, obj->layout->renderingElement(), obj->layout);
+			_renderer.addDynamicChunksDamage();
+			collectStatistics(&obj->statistics);
+		}
+	}
+	
+	if (drawOverlay)
+	{
+		buildOverlayVertices(rc);
+		_renderer.addDynamicChunksDamage();
+		collectStatistics(nullptr);
 	}
 	
+	if (_renderer.hasDamage())
+	{
+		auto currentBuffer = rs.boundFramebuffer();
+		auto viewportSize = rs.viewportSize();
+		vec4 clearColor = rs.clearColor();
+		
+		rs.bindFramebuffer(_retainedFramebuffer);
+		rs.setClip(true, _renderer.damageInWindowSpace());
+		rs.setClearColor(_retainedClearColor);
+		rc->renderer()->clear(true, false);
+		rs.setClearColor(clearColor);
+		
+		if (drawBackground)
+		{
+			_renderer.setRendernigElement(_renderingElementBackground);
+			_renderer.setAdditionalOffsetAndAlpha(vec3(0.0f, 0.0f, 1.0f));
+			_renderer.render(rc);
+			collectStatistics(nullptr);
+		}
+		
+		for (auto& obj : _layouts)
+		{
+			if (obj->layout->visible())
+			{
+				_renderer.setRendernigElement(obj->layout->renderingElement());
+				_renderer.setAdditionalOffsetAndAlpha(obj->offsetAlpha);
+				_renderer.render(rc);
+				collectStatistics(nullptr);
+			}
+		}
+		
+		if (drawOverlay)
+		{
+			_renderer.setRendernigElement(_renderingElementOverlay);
+			_renderer.setAdditionalOffsetAndAlpha(vec3(0.0f, 0.0f, 1.0f));
+			_renderer.render(rc);
+			collectStatistics(nullptr);
+		}
+		
+		rs.bindFramebuffer(currentBuffer);
+		rs.setViewportSize(viewportSize);
+	}
+	
+	presentRetainedFramebuffer(rc);
+	
+	if (_renderer.statisticsEnabled())
+		_renderer.finishStatisticsFrame();
+	
 	_renderer.endRender(rc);
 }
 
+void Scene::presentRetainedFramebuffer(RenderContext* rc)
+{
+	rc->renderState().setClip(false, recti(vec2i(0), rc->sizei()));
+	rc->renderState().setBlend(false, BlendState::Current);
+	rc->renderer()->renderFullscreenTexture(_retainedFramebuffer->renderTarget(0));
+}
+
 ImageView& Scene::backgroundImageView()
 {
 	return _background;
@@ -402,6 +822,7 @@ void Scene::removeLayoutEntryFromList(LayoutEntry* ptr)
 	{
 		if (i->ptr() == ptr)
 		{
+			_renderRequested = true;
 			_layouts.erase(i);
 			validateTopLevelLayout();
 			return;
@@ -411,6 +832,8 @@ void Scene::removeLayoutEntryFromList(LayoutEntry* ptr)
 
 void Scene::layoutEntryTransitionFinished(LayoutEntry* l)
 {
+	_renderRequested = true;
+	
 	if (l->state == LayoutEntry::State_Disappear)
 	{
 		if (l->layout.valid())
@@ -516,7 +939,7 @@ void Scene::reloadObject(LoadableObject::Pointer obj, ObjectsCache&)
 	Element2d::Pointer l = obj;
 	l->reloadFromFile(obj->origin());
 	l->autoLayoutFromFile(obj->origin());
-	l->autoLayout(_rc->size(), 0.0f);
+	l->autoLayout(_screenSize, 0.0f);
 }
 
 void Scene::broadcastMessage(const Message& msg)
@@ -531,6 +954,7 @@ void Scene::removeAllLayouts()
 		l->layout.reset(nullptr);
 
 	_layouts.clear();
+	_renderRequested = true;
 }
 
 void Scene::setTopLevelLayout(Layout::Pointer l)
@@ -541,6 +965,8 @@ void Scene::setTopLevelLayout(Layout::Pointer l)
 
 void Scene::validateTopLevelLayout()
 {
+	_renderRequested = true;
+	
 	if (_layouts.size() > 1)
 	{
 		auto topLevel = std::find_if(_layouts.begin(), _layouts.end(), [this](const LayoutEntry::Pointer& le)
@@ -565,7 +991,7 @@ Scene::LayoutEntry::LayoutEntry(Scene* own, RenderContext* rc, Layout::Pointer l
 		i.setTarget(own, &Scene::layoutEntryTransitionFinished, this);
 		i.invokeInMainRunLoop();
 	});
-	l->initRenderingElement(rc);
+	l->initRenderingElement(rc, own->_renderer.renderBackend());
 }
 
 Scene::LayoutEntry::~LayoutEntry()
@@ -5,6 +5,7 @@
  *
  */
 
+#include <typeinfo>
 #include <et/rendering/rendercontext.h>
 #include <et-ext/scene2d/scenerenderer.h>
 
@@ -15,25 +16,80 @@ extern std::string et_scene2d_default_shader_vs;
 extern std::string et_scene2d_default_shader_vs_with_screen_pos;
 
 extern std::string et_scene2d_default_shader_fs;
+extern std::string et_scene2d_packed_vertex_shader_header;
+extern std::string et_scene2d_packed_vertex_shader_footer;
+extern std::string et_scene2d_instanced_vertex_shader_header;
 
 const std::string SceneRenderer::defaultProgramName = "et-scene2d-default-shader";
 
 extern const std::string textureSamplerName = "inputTexture";
 extern const std::string additionalOffsetAndAlphaUniform = "additionalOffsetAndAlpha";
+extern const std::string objectParametersUniform = "objectParameters";
+
+/*
+ * Array uniforms could be reported with or without subscript of the first element
+ */
+static Program::Uniform arrayUniform(const Program::Pointer& program, const std::string& name)
+{
+	Program::Uniform result = program->getUniform(name);
+	return (result.location == -1) ? program->getUniform(name + "[0]") : result;
+}
+
+static bool rectIsEmpty(const rect& r)
+	{ return (r.width <= 0.0f) || (r.height <= 0.0f); }
+
+static bool rectsIntersect(const rect& a, const rect& b)
+{
+	return (a.left < b.left + b.width) && (b.left < a.left + a.width) &&
+		(a.top < b.top + b.height) && (b.top < a.top + a.height);
+}
+
+static rect mergeRects(const rect& a, const rect& b)
+{
+	if (rectIsEmpty(a)) return b;
+	if (rectIsEmpty(b)) return a;
+	
+	vec2 minValue = minv(a.origin(), b.origin());
+	vec2 maxValue = maxv(a.origin() + a.size(), b.origin() + b.size());
+	return rect(minValue, maxValue - minValue);
+}
+
+static rect intersectRects(const rect& a, const rect& b)
+{
+	vec2 minValue = maxv(a.origin(), b.origin());
+	vec2 maxValue = minv(a.origin() + a.size(), b.origin() + b.size());
+	return rect(minValue, maxv(vec2(0.0f), maxValue - minValue));
+}
+
+static recti intersectRects(const recti& a, const recti& b)
+{
+	vec2i minValue(etMax(a.left, b.left), etMax(a.top, b.top));
+	vec2i maxValue(etMin(a.left + a.width, b.left + b.width), etMin(a.top + a.height, b.top + b.height));
+	return recti(minValue, maxv(vec2i(0), maxValue - minValue));
+}
 
 SceneRenderer::SceneRenderer(RenderContext* rc) :
-	_rc(rc), _additionalOffsetAndAlpha(0.0f, 0.0f, 1.0f)
+	SceneRenderer(rc, rc->size())
 {
-	pushClipRect(recti(vec2i(0), rc->sizei()));
+}
+
+SceneRenderer::SceneRenderer(RenderContext* rc, const vec2& windowSize) :
+	_rc(rc), _windowSize(windowSize), _additionalOffsetAndAlpha(0.0f, 0.0f, 1.0f)
+{
+	pushClipRect(recti(0, 0, static_cast<int>(windowSize.x), static_cast<int>(windowSize.y)));
 	
 	_defaultProgram = createProgramWithFragmentshader(defaultProgramName, et_scene2d_default_shader_fs, false);
-	_defaultProgram.program->setUniform(textureSamplerName, 0);
 	
-	_defaultTexture = rc->textureFactory().genTexture(TextureTarget::Texture_2D, TextureFormat::RGBA,
-		vec2i(1), TextureFormat::RGBA, DataType::UnsignedChar, BinaryDataStorage(4, 0), "scene-default-texture");
-	_defaultTexture->setFiltration(rc, TextureFiltration::Nearest, TextureFiltration::Nearest);
+	if (rc != nullptr)
+	{
+		_defaultProgram.program->setUniform(textureSamplerName, 0);
+		
+		_defaultTexture = rc->textureFactory().genTexture(TextureTarget::Texture_2D, TextureFormat::RGBA,
+			vec2i(1), TextureFormat::RGBA, DataType::UnsignedChar, BinaryDataStorage(4, 0), "scene-default-texture");
+		_defaultTexture->setFiltration(rc, TextureFiltration::Nearest, TextureFiltration::Nearest);
+	}
 	
-	setProjectionMatrices(rc->size());
+	setProjectionMatrices(windowSize);
 }
 
 void s2d::SceneRenderer::resetClipRect()
@@ -53,6 +109,22 @@ void s2d::SceneRenderer::popClipRect()
 	_clip.pop();
 }
 
+bool s2d::SceneRenderer::clipRectVisible(const recti& r) const
+{
+	const recti& c = _clip.top();
+	return (r.width > 0) && (r.height > 0) && (r.left < c.left + c.width) && (c.left < r.left + r.width) &&
+		(r.top < c.top + c.height) && (c.top < r.top + r.height);
+}
+
+rect s2d::SceneRenderer::clipRectInVertexSpace(const recti& c) const
+{
+	/*
+	 * Clip rects are stored in window coordinates (origin at bottom), vertices - in layout coordinates
+	 */
+	return rect(static_cast<float>(c.left), static_cast<float>(_screenClip.height - c.top - c.height),
+		static_cast<float>(c.width), static_cast<float>(c.height));
+}
+
 void s2d::SceneRenderer::setProjectionMatrices(const vec2& contextSize)
 {
 	std::stack<recti> tempClipStack;
@@ -64,7 +136,8 @@ void s2d::SceneRenderer::setProjectionMatrices(const vec2& contextSize)
 	}
 	
 	_clip.pop();
-	_clip.push(recti(vec2i(0), vec2i(static_cast<int>(contextSize.x), static_cast<int>(contextSize.y))));
+	_screenClip = recti(vec2i(0), vec2i(static_cast<int>(contextSize.x), static_cast<int>(contextSize.y)));
+	_clip.push(_screenClip);
 	
 	while (tempClipStack.size())
 	{
@@ -81,29 +154,49 @@ void s2d::SceneRenderer::setProjectionMatrices(const vec2& contextSize)
 	_defaultTransform[3][3] = 1.0f;
 }
 
-SceneVertex* s2d::SceneRenderer::allocateVertices(size_t count, const Texture::Pointer& inTexture,
-	const SceneProgram& inProgram, Element2d* object, PrimitiveType pt)
+size_t s2d::SceneRenderer::allocateVertices(const RenderingElement::VertexRange& range, const recti& clip,
+	const Texture::Pointer& inTexture, const SceneProgram& sourceProgram, Element2d* object, const rect& bounds)
 {
 	ET_ASSERT(_renderingElement.valid());
 	
-	if (object && !object->hasFlag(Flag_DynamicRendering))
-		object = nullptr;
-
+	const SceneProgram& inProgram = programForVertexFormat(sourceProgram, _renderingElement->vertexFormat());
 	const Texture::Pointer& actualTexture = inTexture.valid() ? inTexture : _defaultTexture;
 	
-	bool isDynamicObject = (object != nullptr) && (object->hasFlag(Flag_DynamicRendering));
+	/*
+	 * Dynamic objects sets their uniforms directly and always get own chunk,
+	 * objects with parameters share chunk and get slot in objectParameters array
+	 */
+	bool isDynamicObject = (object != nullptr) && object->hasFlag(Flag_DynamicRendering);
+	bool hasParameters = !isDynamicObject && (object != nullptr) && object->hasFlag(Flag_HasObjectParameters) &&
+		(inProgram.objectParameters.location != -1);
+	
+	size_t objectSlot = 0;
+	size_t firstIndex = RenderingElement::indexForVertex(range.first);
+	size_t indexCount = RenderingElement::indexForVertex(range.count);
 	bool shouldAdd = isDynamicObject || _renderingElement->chunks.empty();
 	if ((shouldAdd == false) && _renderingElement->chunks.size())
 	{
 		RenderChunk& lastChunk = _renderingElement->chunks.back();
 		
-		bool sameConfiguration = (lastChunk.clip == _clip.top()) && (lastChunk.texture == actualTexture) &&
-			(lastChunk.program.program == inProgram.program) && (lastChunk.primitiveType == pt);
+		bool sameConfiguration = (lastChunk.object == nullptr) && (lastChunk.first + lastChunk.count == firstIndex) &&
+			(lastChunk.clip == clip) && (lastChunk.texture == actualTexture) &&
+			(lastChunk.program.identifier == inProgram.identifier);
+		
+		if (sameConfiguration && hasParameters)
+		{
+			objectSlot = lastChunk.slotForObject(object);
+			sameConfiguration = (objectSlot < ObjectParameters_MaxObjects);
+		}
 		
 		if (sameConfiguration)
-			lastChunk.count += count;
+		{
+			lastChunk.count += indexCount;
+			lastChunk.bounds = mergeRects(lastChunk.bounds, bounds);
+		}
 		else
+		{
 			shouldAdd = true;
+		}
 	}
 
 	if (shouldAdd)
@@ -111,22 +204,189 @@ SceneVertex* s2d::SceneRenderer::allocateVertices(size_t count, const Texture::P
 		_lastProgram = inProgram;
 		_lastTexture = actualTexture;
 		
-		_renderingElement->chunks.emplace_back(_renderingElement->allocatedVertices, count,
-			_clip.top(), _lastTexture, _lastProgram, object, pt);
+		_renderingElement->chunks.emplace_back(firstIndex, indexCount, clip,
+			_lastTexture, _lastProgram, isDynamicObject ? object : nullptr);
+		_renderingElement->chunks.back().bounds = bounds;
+		
+		objectSlot = hasParameters ? _renderingElement->chunks.back().slotForObject(object) : 0;
 	}
 	
-	return _renderingElement->allocateVertices(count);
+	return objectSlot;
 }
 
 void SceneRenderer::addVertices(const SceneVertexList& vertices, const Texture::Pointer& texture,
-	const SceneProgram& program, Element2d* owner, PrimitiveType pt)
+	const SceneProgram& program, Element2d* owner)
 {
 	size_t count = vertices.lastElementIndex();
 	ET_ASSERT((count > 0) && _renderingElement.valid() && program.valid());
+	ET_ASSERT((count % QuadGeometry_Vertices == 0) && "Scene vertices should be built as quads");
 	
-	auto target = allocateVertices(count, texture, program, owner, pt);
-	for (const auto& v : vertices)
-		*target++ = v;
+	if (_statisticsEnabled && (owner != nullptr))
+		trackElementVersion(owner);
+	
+	recti clip = _clip.top();
+	const SceneVertexList* source = &vertices;
+	
+	rect bounds(0.0f, 0.0f, 0.0f, 0.0f);
+	if (_damageTrackingEnabled)
+		bounds = trackVerticesDamage(vertices, clip, owner);
+	
+	if (_clippingMode == ClippingMode::CPU)
+	{
+		auto clipResult = clipQuads(vertices, _clippedVertices, clipRectInVertexSpace(clip));
+		
+		if (clipResult == ClipResult_Culled)
+			return;
+		
+		if (clipResult == ClipResult_Clipped)
+			source = &_clippedVertices;
+		
+		if (clipResult != ClipResult_RequiresScissor)
+			clip = _screenClip;
+		
+		count = source->lastElementIndex();
+		if (count == 0)
+			return;
+	}
+	
+	auto range = _renderingElement->allocateVertices(vertices, count, owner, source != &vertices);
+	if (range.count > 0)
+	{
+		size_t objectSlot = allocateVertices(range, clip, texture, program, owner, bounds);
+		_renderingElement->chunks.back().vertices += count;
+		_renderingElement->writeVertices(vertices, *source, range, objectSlot);
+	}
+}
+
+void SceneRenderer::trackElementVersion(const Element2d* owner)
+{
+	/*
+	 * Content version changes each time element invalidates, so changed version
+	 * means that element rebuilt its vertices since it was seen last time
+	 */
+	auto& record = _elementRecords[owner];
+	if (record.frame == _statisticsFrame)
+		return;
+	
+	if (record.version != owner->contentVersion())
+	{
+		++_statistics.rebuiltElements;
+		++_statistics.rebuiltElementTypes[elementClassName(typeid(*owner))];
+	}
+	
+	record.version = owner->contentVersion();
+	record.frame = _statisticsFrame;
+}
+
+rect SceneRenderer::trackVerticesDamage(const SceneVertexList& vertices, const recti& clip, const Element2d* owner)
+{
+	auto& record = _renderingElement->_damageRecords[&vertices];
+	
+	/*
+	 * Bounds are recalculated only for vertex lists whose owner changed content version,
+	 * lists without owner could not be tracked and are always considered changed
+	 */
+	size_t version = (owner == nullptr) ? 0 : owner->contentVersion();
+	bool changed = (owner == nullptr) || (record.buildIndex == 0) || (record.version != version);
+	
+	if (changed)
+	{
+		rect bounds = intersectRects(verticesBounds(vertices), clipRectInVertexSpace(clip));
+		addDamage(record.bounds);
+		addDamage(bounds);
+		
+		record.bounds = bounds;
+		record.version = version;
+	}
+	
+	record.buildIndex = _renderingElement->_damageBuildIndex;
+	return record.bounds;
+}
+
+void SceneRenderer::resetDamage()
+{
+	_damage = rect(0.0f, 0.0f, 0.0f, 0.0f);
+	_fullDamage = false;
+}
+
+void SceneRenderer::addDamage(const rect& r)
+{
+	if (!_fullDamage && !rectIsEmpty(r))
+		_damage = mergeRects(_damage, r);
+}
+
+void SceneRenderer::addFullDamage()
+{
+	_damage = clipRectInVertexSpace(_screenClip);
+	_fullDamage = true;
+}
+
+recti SceneRenderer::damageInWindowSpace() const
+{
+	/*
+	 * Extended by a pixel, so antialiased edges of changed vertices are also redrawn
+	 */
+	rect screenDamage = intersectRects(_damage, clipRectInVertexSpace(_screenClip));
+	
+	int left = static_cast<int>(std::floor(screenDamage.left)) - 1;
+	int top = static_cast<int>(std::floor(screenDamage.top)) - 1;
+	int right = static_cast<int>(std::ceil(screenDamage.left + screenDamage.width)) + 1;
+	int bottom = static_cast<int>(std::ceil(screenDamage.top + screenDamage.height)) + 1;
+	
+	return intersectRects(recti(left, _screenClip.height - bottom, right - left, bottom - top), _screenClip);
+}
+
+void SceneRenderer::startTrackingDamage()
+{
+	ET_ASSERT(_renderingElement.valid());
+	++_renderingElement->_damageBuildIndex;
+}
+
+void SceneRenderer::finishTrackingDamage()
+{
+	ET_ASSERT(_renderingElement.valid());
+	
+	auto& records = _renderingElement->_damageRecords;
+	for (auto i = records.begin(); i != records.end(); )
+	{
+		if (i->second.buildIndex == _renderingElement->_damageBuildIndex)
+		{
+			++i;
+		}
+		else
+		{
+			addDamage(i->second.bounds);
+			i = records.erase(i);
+		}
+	}
+}
+
+void SceneRenderer::addDynamicChunksDamage()
+{
+	ET_ASSERT(_renderingElement.valid());
+	
+	for (const auto& i : _renderingElement->chunks)
+	{
+		if (i.object != nullptr)
+			addDamage(i.bounds);
+	}
+}
+
+void SceneRenderer::resetStatistics()
+{
+	_statistics = RenderStatistics();
+}
+
+void SceneRenderer::finishStatisticsFrame()
+{
+	for (auto i = _elementRecords.begin(); i != _elementRecords.end(); )
+	{
+		if (i->second.frame + ElementRecordLifetime < _statisticsFrame)
+			i = _elementRecords.erase(i);
+		else
+			++i;
+	}
+	++_statisticsFrame;
 }
 
 void s2d::SceneRenderer::setRendernigElement(const RenderingElement::Pointer& r)
@@ -137,6 +397,8 @@ void s2d::SceneRenderer::setRendernigElement(const RenderingElement::Pointer& r)
 
 void s2d::SceneRenderer::beginRender(RenderContext* rc)
 {
+	if (_renderBackend.valid()) return;
+	
 	_depthMaskEnabled = rc->renderState().depthMask();
 	_blendEnabled = rc->renderState().blendEnabled();
 	_lastColorBlendState = rc->renderState().blendStateForColor();
@@ -153,14 +415,53 @@ void s2d::SceneRenderer::beginRender(RenderContext* rc)
 void s2d::SceneRenderer::render(RenderContext* rc)
 {
 	if (!_renderingElement.valid()) return;
+	
+	double startTime = _statisticsEnabled ? RenderStatistics::currentTime() : 0.0;
+	
+	const auto& vao = _renderingElement->vertexArrayObject();
+	size_t baseIndex = _renderingElement->baseIndex();
+	
+	if (_renderingElement->backend().valid())
+		renderToBackend(_renderingElement->backend(), baseIndex);
+	else
+		renderChunks(rc, vao->indexBuffer(), baseIndex);
+	
+	if (_statisticsEnabled)
+	{
+		_statistics.renderTime += RenderStatistics::currentTime() - startTime;
+		collectChunkStatistics();
+	}
+}
 
+void SceneRenderer::renderChunks(RenderContext* rc, const IndexBuffer::Pointer& indexBuffer, size_t baseIndex)
+{
 	RenderState& rs = rc->renderState();
 	Renderer* renderer = rc->renderer();
-	const IndexBuffer::Pointer& indexBuffer = _renderingElement->vertexArrayObject()->indexBuffer();
+	
+	if (_damageTrackingEnabled)
+		_damageWindowRect = damageInWindowSpace();
+	
+	_skippedChunks = 0;
+	_submittedVertices = 0;
+	
+	bool instanced = (_renderingElement->vertexFormat() == RenderingElement::VertexFormat::Instanced);
 	
 	Program::Pointer lastBoundProgram;
 	for (auto& i : _renderingElement->chunks)
 	{
+		recti clip = i.clip + _additionalWindowOffset;
+		
+		if (_damageTrackingEnabled)
+		{
+			if (!_fullDamage && !rectsIntersect(i.bounds, _damage))
+			{
+				++_skippedChunks;
+				continue;
+			}
+			
+			clip = intersectRects(clip, _damageWindowRect);
+		}
+		
 		if (lastBoundProgram != i.program.program)
 		{
 			lastBoundProgram = i.program.program;
@@ -172,15 +473,102 @@ void s2d::SceneRenderer::render(RenderContext* rc)
 		if (i.object != nullptr)
 			i.object->setProgramParameters(rc, lastBoundProgram);
 		
+		if (i.parameterObjectsCount > 0)
+			setObjectParameters(i);
+		
 		rs.bindTexture(0, i.texture);
-		rs.setClip(true, i.clip + _additionalWindowOffset);
+		rs.setClip(true, clip);
 		
-		renderer->drawElements(i.primitiveType, indexBuffer, i.first, i.count);
+		_submittedVertices += i.vertices;
+		
+		if (instanced)
+			drawInstances(rc, indexBuffer, i, baseIndex);
+		else
+			renderer->drawElements(PrimitiveType::Triangles, indexBuffer, baseIndex + i.first, i.count);
 	}
 }
 
+/*
+ * Index buffer contains single quad, drawn instances are selected by attribute pointers
+ */
+void SceneRenderer::drawInstances(RenderContext* rc, const IndexBuffer::Pointer& indexBuffer,
+	const RenderChunk& chunk, size_t baseIndex)
+{
+	_renderingElement->setFirstInstance((baseIndex + chunk.first) / QuadGeometry_Indices);
+	rc->renderer()->drawElementsInstanced(indexBuffer, 0, QuadGeometry_Indices, chunk.count / QuadGeometry_Indices);
+}
+
+void SceneRenderer::renderToBackend(const RenderBackend::Pointer& backend, size_t baseIndex)
+{
+	_skippedChunks = 0;
+	_submittedVertices = 0;
+	
+	bool instanced = (_renderingElement->vertexFormat() == RenderingElement::VertexFormat::Instanced);
+	
+	for (const auto& i : _renderingElement->chunks)
+	{
+		_submittedVertices += i.vertices;
+		gatherObjectParameters(i);
+		
+		if (instanced)
+		{
+			backend->drawInstances(_renderingElement.ptr(), i, (baseIndex + i.first) / QuadGeometry_Indices,
+				i.count / QuadGeometry_Indices, _objectParameters, i.parameterObjectsCount);
+		}
+		else
+		{
+			backend->drawChunk(_renderingElement.ptr(), i, baseIndex + i.first, _objectParameters, i.parameterObjectsCount);
+		}
+	}
+}
+
+void SceneRenderer::collectChunkStatistics()
+{
+	const auto& chunks = _renderingElement->chunks;
+	if (chunks.empty()) return;
+	
+	const RenderChunk* previous = nullptr;
+	for (const auto& i : chunks)
+	{
+		bool first = (previous == nullptr);
+		_statistics.programSwitches += (first || (previous->program.identifier != i.program.identifier)) ? 1 : 0;
+		_statistics.textureSwitches += (first || (previous->texture != i.texture)) ? 1 : 0;
+		_statistics.clipSwitches += (first || (previous->clip == i.clip)) ? 0 : 1;
+		previous = &i;
+	}
+	
+	_statistics.chunks += chunks.size();
+	_statistics.drawCalls += chunks.size() - _skippedChunks;
+	_statistics.drawnVertices += _submittedVertices;
+}
+
+void SceneRenderer::gatherObjectParameters(const RenderChunk& chunk)
+{
+	for (size_t i = 0; i < chunk.parameterObjectsCount; ++i)
+		_objectParameters[i] = chunk.parameterObjects[i]->objectParameters();
+}
+
+void SceneRenderer::setObjectParameters(const RenderChunk& chunk)
+{
+	const Program::Uniform& u = chunk.program.objectParameters;
+	ET_ASSERT(u.location != -1);
+	
+	gatherObjectParameters(chunk);
+	chunk.program.program->setUniform(u.location, u.type, _objectParameters, chunk.parameterObjectsCount);
+}
+
+void SceneRenderer::setVertexBuildThreads(size_t threads)
+{
+	if (threads == 0)
+		_vertexBuildPool.reset(nullptr);
+	else if (_vertexBuildPool.invalid() || (_vertexBuildPool->threadsCount() != threads))
+		_vertexBuildPool = VertexBuildPool::Pointer::create(threads);
+}
+
 void SceneRenderer::endRender(RenderContext* rc)
 {
+	if (_renderBackend.valid()) return;
+	
 	auto& rs = rc->renderState();
 	rs.setClip(_clipeEnabled, _latestClipRect);
 	rs.setDepthMask(_depthMaskEnabled);
@@ -191,15 +579,44 @@ void SceneRenderer::endRender(RenderContext* rc)
 void SceneRenderer::setAdditionalOffsetAndAlpha(const vec3& offsetAndAlpha)
 {
 	_additionalOffsetAndAlpha = vec3(2.0f * offsetAndAlpha.xy(), offsetAndAlpha.z);
-	_additionalWindowOffset.left = static_cast<int>(offsetAndAlpha.x * _rc->size().x);
-	_additionalWindowOffset.top = static_cast<int>(offsetAndAlpha.y * _rc->size().y);
+	_additionalWindowOffset.left = static_cast<int>(offsetAndAlpha.x * _windowSize.x);
+	_additionalWindowOffset.top = static_cast<int>(offsetAndAlpha.y * _windowSize.y);
 }
 
 SceneProgram SceneRenderer::createProgramWithShaders(const std::string& name, const std::string& vs, const std::string& fs)
 {
-	Program::Pointer existingProgram = _programsCache.findAnyObject(name);
+	SceneProgram program = createProgram(name, vs, fs);
+	
+	ProgramSource& source = _programSources[program.identifier];
+	source.name = name;
+	source.vertexShader = vs;
+	source.fragmentShader = fs;
+	
+	return program;
+}
+
+SceneProgram SceneRenderer::createProgram(const std::string& name, const std::string& vs, const std::string& fs)
+{
+	uint32_t& identifier = _programIdentifiers[name];
+	if (identifier == 0)
+		identifier = static_cast<uint32_t>(_programIdentifiers.size());
 	
 	SceneProgram program;
+	program.identifier = identifier;
+	
+	/*
+	 * Without render context uniforms are only marked as present when declared in sources,
+	 * so chunks are split and batched as they would be with compiled program
+	 */
+	if (_rc == nullptr)
+	{
+		if ((vs.find(objectParametersUniform) != std::string::npos) || (fs.find(objectParametersUniform) != std::string::npos))
+			program.objectParameters.location = 0;
+		
+		return program;
+	}
+	
+	Program::Pointer existingProgram = _programsCache.findAnyObject(name);
 	if (existingProgram.invalid())
 	{
 		program.program = _rc->programFactory().genProgram(name, vs, fs);
@@ -212,6 +629,7 @@ SceneProgram SceneRenderer::createProgramWithShaders(const std::string& name, co
 	}
 	
 	program.additionalOffsetAndAlpha = program.program->getUniform(additionalOffsetAndAlphaUniform);
+	program.objectParameters = arrayUniform(program.program, objectParametersUniform);
 	
 	ET_ASSERT((program.additionalOffsetAndAlpha.location != -1) &&
 		"Program should contain uniform for additional offset and alpha, of type vec3 and named additionalOffsetAndAlpha");
@@ -219,6 +637,57 @@ SceneProgram SceneRenderer::createProgramWithShaders(const std::string& name, co
 	return program;
 }
 
+const SceneProgram& SceneRenderer::programForVertexFormat(const SceneProgram& program,
+	RenderingElement::VertexFormat format)
+{
+	if (format == RenderingElement::VertexFormat::Default)
+		return program;
+	
+	bool packed = (format == RenderingElement::VertexFormat::Packed);
+	auto& variants = packed ? _packedPrograms : _instancedPrograms;
+	
+	auto existing = variants.find(program.identifier);
+	if (existing != variants.end())
+		return existing->second;
+	
+	auto source = _programSources.find(program.identifier);
+	if (source == _programSources.end())
+	{
+		log::error("Program was not created by scene renderer and can not be used with packed or instanced vertices.");
+		return program;
+	}
+	
+	/*
+	 * Packed and instanced variants declare their attributes, unpack them into the globals
+	 * and redirect Vertex, TexCoord0, Color and main() of the original shader via preprocessor
+	 */
+	std::string vs = source->second.vertexShader;
+	const char* declarations[] =
+	{
+		"etVertexIn vec3 Vertex;",
+		"etVertexIn vec4 TexCoord0;",
+		"etVertexIn vec4 Color;",
+	};
+	
+	for (const char* decl : declarations)
+	{
+		auto pos = vs.find(decl);
+		ET_ASSERT((pos != std::string::npos) && "Scene vertex shaders should declare Vertex, TexCoord0 and Color inputs");
+		if (pos != std::string::npos)
+			vs.erase(pos, std::string(decl).size());
+	}
+	
+	vs = (packed ? et_scene2d_packed_vertex_shader_header : et_scene2d_instanced_vertex_shader_header) +
+		vs + et_scene2d_packed_vertex_shader_footer;
+	
+	auto& result = variants[program.identifier];
+	result = createProgram(source->second.name + (packed ? "-packed" : "-instanced"), vs, source->second.fragmentShader);
+	
+	if (result.program.valid())
+		result.program->setUniform(textureSamplerName, 0);
+	return result;
+}
+
 SceneProgram SceneRenderer::createProgramWithFragmentshader(const std::string& name, const std::string& fs,
 	bool includeScreenSpacePosVarying)
 {
@@ -243,7 +712,7 @@ std::string et_scene2d_default_shader_vs =
 		"vec4 alphaScaledColor = Color * vec4(1.0, 1.0, 1.0, additionalOffsetAndAlpha.z);"
 		"additiveColor = alphaScaledColor * TexCoord0.w;"
 		"tintColor = alphaScaledColor * (1.0 - TexCoord0.w);"
-		"vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+		"vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 		"gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 	"}";
 
@@ -263,11 +732,78 @@ std::string et_scene2d_default_shader_vs_with_screen_pos =
 		"vec4 alphaScaledColor = Color * vec4(1.0, 1.0, 1.0, additionalOffsetAndAlpha.z);"
 		"additiveColor = alphaScaledColor * TexCoord0.w;"
 		"tintColor = alphaScaledColor * (1.0 - TexCoord0.w);"
-		"vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+		"vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 		"gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 		"screenSpaceTexCoord = 0.5 + 0.5 * gl_Position.xy / gl_Position.w;"
 	"}";
 
+std::string et_scene2d_packed_vertex_shader_header = R"(
+etVertexIn vec3 Vertex;
+etVertexIn vec4 TexCoord0;
+vec3 s2dVertex;
+vec4 s2dTexCoord0;
+vec4 s2dColor;
+vec2 s2dUnpack(float value, float base, float scale)
+{
+	float hi = floor((value + 0.5) / base);
+	return vec2(hi, value - hi * base) * scale;
+}
+void s2dUnpackVertex()
+{
+	float objectSlot = floor((TexCoord0.z + 0.5) / 65536.0);
+	s2dVertex = vec3(Vertex.xy, objectSlot);
+	s2dTexCoord0 = vec4(TexCoord0.xy, s2dUnpack(Vertex.z, 4096.0, 1.0 / 4095.0));
+	s2dColor = vec4(s2dUnpack(TexCoord0.z - 65536.0 * objectSlot, 256.0, 1.0 / 255.0),
+		s2dUnpack(TexCoord0.w, 256.0, 1.0 / 255.0));
+}
+#define Vertex s2dVertex
+#define TexCoord0 s2dTexCoord0
+#define Color s2dColor
+#define main s2dMain
+)";
+
+std::string et_scene2d_instanced_vertex_shader_header = R"(
+etVertexIn vec4 Vertex;
+etVertexIn vec4 TexCoord0;
+etVertexIn vec4 TexCoord1;
+etVertexIn vec4 Color;
+vec3 s2dVertex;
+vec4 s2dTexCoord0;
+vec4 s2dColor;
+vec2 s2dUnpack(float value, float base, float scale)
+{
+	float hi = floor((value + 0.5) / base);
+	return vec2(hi, value - hi * base) * scale;
+}
+void s2dUnpackVertex()
+{
+	int slotAndFlags = int(TexCoord1.w + 0.5);
+	int flags = slotAndFlags / 256;
+	bool right = (gl_VertexID == 1) || (gl_VertexID == 2);
+	bool top = (gl_VertexID >= 2);
+	vec2 corner = vec2(right ? 1.0 : 0.0, top ? 1.0 : 0.0);
+	vec2 texCoordCorner = ((flags & 1) != 0) ? corner.yx : corner;
+	bool secondColor = (right && top) || (right && ((flags & 2) != 0)) || (top && ((flags & 4) != 0));
+	vec2 color = secondColor ? Color.zw : Color.xy;
+	s2dVertex = vec3(Vertex.xy + corner.x * Vertex.zw + corner.y * TexCoord1.xy, float(slotAndFlags - 256 * flags));
+	s2dTexCoord0 = vec4(mix(TexCoord0.xy, TexCoord0.zw, texCoordCorner), s2dUnpack(TexCoord1.z, 4096.0, 1.0 / 4095.0));
+	s2dColor = vec4(s2dUnpack(color.x, 256.0, 1.0 / 255.0), s2dUnpack(color.y, 256.0, 1.0 / 255.0));
+}
+#define Vertex s2dVertex
+#define TexCoord0 s2dTexCoord0
+#define Color s2dColor
+#define main s2dMain
+)";
+
+std::string et_scene2d_packed_vertex_shader_footer = R"(
+#undef main
+void main()
+{
+	s2dUnpackVertex();
+	s2dMain();
+}
+)";
+
 std::string et_scene2d_default_shader_fs =
 	"uniform etLowp sampler2D " + textureSamplerName + ";"
 	"etFragmentIn etHighp vec2 texCoord;"
@@ -33,7 +33,7 @@ Scroll::Scroll(Element2d* parent, const std::string& name) :
 
 	setFlag(Flag_HandlesChildEvents);
 	setFlag(Flag_ClipToBounds);
-	startUpdates();
+	resumeUpdates();
 }
 
 void Scroll::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
@@ -71,7 +71,7 @@ void Scroll::buildVertices(RenderContext* rc, SceneRenderer&)
 	
 	if (_scrollbarsColor.w > 0.0f)
 	{
-		float scaledScollbarSize = scrollbarSize * static_cast<float>(rc->screenScaleFactor());
+		float scaledScollbarSize = scrollbarSize * ((rc != nullptr) ? static_cast<float>(rc->screenScaleFactor()) : 1.0f);
 		float barHeight = size().y * (size().y / _contentSize.y);
 		float barOffset = size().y * (_contentOffset.y / _contentSize.y);
 		vec2 origin(size().x - 2.0f * scaledScollbarSize, -barOffset);
@@ -89,19 +89,19 @@ void Scroll::buildVertices(RenderContext* rc, SceneRenderer&)
 	setContentValid();
 }
 
-const mat4& Scroll::finalTransform()
+const Transform2d& Scroll::finalTransform()
 {
 	Element2d::finalTransform();
 	
 	_localFinalTransform = buildFinalTransform(offset(), angle(), scale(), position() + _contentOffset) * parentFinalTransform();
 	
 	if (_floorOffset)
-		_localFinalTransform[3].xy() = floorv(_localFinalTransform[3].xy());
+		_localFinalTransform.translation = floorv(_localFinalTransform.translation);
 	
 	return _localFinalTransform;
 }
 
-const mat4& Scroll::finalInverseTransform()
+const Transform2d& Scroll::finalInverseTransform()
 {
 	_localInverseTransform = Element2d::finalTransform().inverse();
 	return _localInverseTransform;
@@ -110,6 +110,7 @@ const mat4& Scroll::finalInverseTransform()
 bool Scroll::pointerPressed(const PointerInputInfo& p)
 {
 	_contentOffsetAnimator.cancelUpdates();
+	resumeUpdates();
 	
 	if ((_currentPointer.id == 0) && (p.type == PointerType_General))
 	{
@@ -126,6 +127,8 @@ bool Scroll::pointerPressed(const PointerInputInfo& p)
 
 bool Scroll::pointerMoved(const PointerInputInfo& p)
 {
+	resumeUpdates();
+	
 	if (p.id != _currentPointer.id)
 	{
 		broadcastMoved(p);
@@ -191,6 +194,8 @@ bool Scroll::pointerMoved(const PointerInputInfo& p)
 
 bool Scroll::pointerReleased(const PointerInputInfo& p)
 {
+	resumeUpdates();
+	
 	if (p.id == _currentPointer.id)
 	{
 		if (!_pointerCaptured)
@@ -213,6 +218,8 @@ bool Scroll::pointerReleased(const PointerInputInfo& p)
 
 bool Scroll::pointerCancelled(const PointerInputInfo& p)
 {
+	resumeUpdates();
+	
 	_pointerCaptured = false;
 	_currentPointer = PointerInputInfo();
 	
@@ -515,12 +522,37 @@ void Scroll::update(float t)
 	{
 		invalidateContent();
 	}
+	
+	if (settled())
+	{
+		_updating = false;
+		cancelUpdates();
+	}
+}
+
+void Scroll::resumeUpdates()
+{
+	if (_updating) return;
+	
+	_updating = true;
+	_updateTime = 0.0f;
+	startUpdates();
+}
+
+bool Scroll::settled()
+{
+	bool bouncing = (horizontalBounce() && (_bouncing.x != BounceDirection_None)) ||
+		(verticalBounce() && (_bouncing.y != BounceDirection_None));
+	
+	return !(_manualScrolling || bouncing || _contentOffsetAnimator.running() ||
+		(_velocity.dotSelf() > 0.0f) || (_scrollbarsAlpha > 0.0f) || (_scrollbarsAlphaTarget > 0.0f));
 }
 
 void Scroll::setContentSize(const vec2& cs)
 {
 	_contentSize = cs;
 	invalidateContent();
+	resumeUpdates();
 }
 
 void Scroll::adjustContentSize(bool includeHiddenItems)
@@ -544,6 +576,7 @@ void Scroll::applyContentOffset(const vec2& dOffset, float duration)
 void Scroll::setContentOffset(const vec2& aOffset, float duration)
 {
 	_contentOffsetAnimator.cancelUpdates();
+	resumeUpdates();
 	
 	if (duration == 0.0f)
 	{
@@ -653,6 +686,7 @@ void Scroll::setPointerScrollDuration(float d)
 void Scroll::setBounce(size_t b)
 {
 	_bounce = b;
+	resumeUpdates();
 }
 
 void Scroll::setBounceExtent(const vec2& e)
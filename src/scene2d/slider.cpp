@@ -80,7 +80,7 @@ void Slider::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
 
 void Slider::buildVertices(RenderContext*, SceneRenderer&)
 {
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	rect mainRect(vec2(0.0f), size());
 	
 	_backgroundVertices.setOffset(0);
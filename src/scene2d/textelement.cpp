@@ -33,7 +33,7 @@ const float maxShadowDistance = 1.0f;
 TextElement::TextElement(Element2d* parent, const Font::Pointer& f, float fsz, const std::string& name) :
 	Element2d(parent, ET_S2D_PASS_NAME_TO_BASE_CLASS), _font(f), _fontSize(fsz)
 {
-	setFlag(s2d::Flag_DynamicRendering);
+	setFlag(s2d::Flag_HasObjectParameters);
 }
 
 void TextElement::setFont(const Font::Pointer& f)
@@ -132,7 +132,6 @@ void TextElement::initTextProgram(SceneRenderer& r)
 	};
 	
 	_textProgram = r.createProgramWithShaders(programNames[_textStyle], vertexShaders[_textStyle], fragmentShaders[_textStyle]);
-	_shadowUniform = _textProgram.program->getUniform("shadowOffset");
 }
 
 void TextElement::setTextStyle(TextStyle style)
@@ -140,19 +139,22 @@ void TextElement::setTextStyle(TextStyle style)
 	if (style == _textStyle) return;
 	
 	_textStyle = style;
-	_textProgram.program.reset(nullptr);
+	_textProgram = SceneProgram();
 }
 
 void TextElement::setShadowOffset(const vec2& o)
 {
 	_shadowOffset.x = +(std::abs(o.x) > maxShadowDistance ? maxShadowDistance : o.x);
 	_shadowOffset.y = -(std::abs(o.y) > maxShadowDistance ? maxShadowDistance : o.y);
+	invalidateContent();
 }
 
-void TextElement::setProgramParameters(et::RenderContext*, et::Program::Pointer& p)
+vec4 TextElement::objectParameters()
 {
-	if ((_textStyle == TextStyle_SignedDistanceFieldShadow) && (p == _textProgram.program))
-		p->setUniform(_shadowUniform, _shadowOffset * _font->generator()->texture()->texel());
+	/*
+	 * Only shadow program reads parameters, for other styles renderer ignores them
+	 */
+	return vec4(_shadowOffset * _font->generator()->texel(), 0.0f, 0.0f);
 }
 
 /*
@@ -174,7 +176,7 @@ std::string et_scene2d_default_text_shader_sdf_vs_base =
 "	tintColor.w *= additionalOffsetAndAlpha.z;"
 "	sdfParams.x = TexCoord0.z - TexCoord0.w;"
 "	sdfParams.y = TexCoord0.z + TexCoord0.w;"
-"	vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 "	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 "}";
 
@@ -195,7 +197,7 @@ std::string et_scene2d_default_text_shader_sdf_fs_plain =
 std::string et_scene2d_default_text_shader_sdf_vs_shadow =
 "uniform mat4 mTransform;"
 "uniform vec3 additionalOffsetAndAlpha;"
-"uniform vec2 shadowOffset;"
+"uniform vec4 objectParameters[" + intToStr(ObjectParameters_MaxObjects) + "];"
 "etVertexIn vec3 Vertex;"
 "etVertexIn vec4 TexCoord0;"
 "etVertexIn vec4 Color;"
@@ -206,12 +208,12 @@ std::string et_scene2d_default_text_shader_sdf_vs_shadow =
 "void main()"
 "{"
 "	texCoord = TexCoord0.xy;"
-"	shadowTexCoord = TexCoord0.xy - shadowOffset;"
+"	shadowTexCoord = TexCoord0.xy - objectParameters[int(Vertex.z)].xy;"
 "	tintColor = Color;"
 "	tintColor.w *= additionalOffsetAndAlpha.z;"
 "	sdfParams.x = TexCoord0.z - TexCoord0.w;"
 "	sdfParams.y = TexCoord0.z + TexCoord0.w;"
-"	vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 "	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 "}";
 
@@ -253,7 +255,7 @@ std::string et_scene2d_default_text_shader_sdf_vs_bevel =
 "	tintColor.w *= additionalOffsetAndAlpha.z;"
 "	sdfParams.x = TexCoord0.z - TexCoord0.w;"
 "	sdfParams.y = TexCoord0.z + TexCoord0.w;"
-"	vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 "	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 "}";
 
@@ -323,7 +325,7 @@ std::string et_scene2d_default_text_shader_vs_plain =
 "	texCoord = TexCoord0.xy;"
 "	tintColor = Color;"
 "	tintColor.w *= additionalOffsetAndAlpha.z;"
-"	vec4 vTransformed = mTransform * vec4(Vertex, 1.0);"
+"	vec4 vTransformed = mTransform * vec4(Vertex.xy, 0.0, 1.0);"
 "	gl_Position = vTransformed + vec4(vTransformed.w * additionalOffsetAndAlpha.xy, 0.0, 0.0);"
 "}";
 
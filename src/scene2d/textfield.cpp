@@ -68,7 +68,7 @@ void TextField::addToRenderQueue(RenderContext* rc, SceneRenderer& r)
 void TextField::buildVertices(RenderContext*, SceneRenderer&)
 {
 	vec4 alphaScale = vec4(1.0f, finalAlpha());
-	mat4 transform = finalTransform();
+	Transform2d transform = finalTransform();
 	rect wholeRect(vec2(0.0f), size());
 
 	_backgroundVertices.setOffset(0);
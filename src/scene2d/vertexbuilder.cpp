@@ -12,20 +12,73 @@
 using namespace et;
 using namespace et::s2d;
 
+inline float packUnitFloatPair(float hi, float lo, float scale, float base)
+{
+	return std::floor(clamp(hi, 0.0f, 1.0f) * scale + 0.5f) * base + std::floor(clamp(lo, 0.0f, 1.0f) * scale + 0.5f);
+}
+
+void et::s2d::packSceneVertex(const SceneVertex& source, PackedSceneVertex& target)
+{
+	target.position.x = source.position.x;
+	target.position.y = source.position.y;
+	target.position.z = packUnitFloatPair(source.texCoord.z, source.texCoord.w, 4095.0f, 4096.0f);
+	target.texCoord.x = source.texCoord.x;
+	target.texCoord.y = source.texCoord.y;
+	target.texCoord.z = packUnitFloatPair(source.color.x, source.color.y, 255.0f, 256.0f);
+	target.texCoord.w = packUnitFloatPair(source.color.z, source.color.w, 255.0f, 256.0f);
+}
+
+void et::s2d::packSceneQuad(const SceneVertex* quad, SceneQuadInstance& target)
+{
+	/*
+	 * Quad vertices are bottom left, bottom right, top right and top left
+	 */
+	const SceneVertex& v0 = quad[0];
+	const SceneVertex& v1 = quad[1];
+	const SceneVertex& v2 = quad[2];
+	const SceneVertex& v3 = quad[3];
+	
+	vec2 xAxis = v1.position.xy() - v0.position.xy();
+	vec2 yAxis = v3.position.xy() - v0.position.xy();
+	
+	vec2 directTexCoord(v2.texCoord.x, v0.texCoord.y);
+	vec2 transposedTexCoord(v0.texCoord.x, v2.texCoord.y);
+	
+	uint32_t flags = 0;
+	if ((v1.texCoord.xy() - transposedTexCoord).dotSelf() < (v1.texCoord.xy() - directTexCoord).dotSelf())
+		flags |= SceneQuadInstanceFlag_TransposedTexCoord;
+	
+	if ((v1.color - v0.color).dotSelf() > 0.0f)
+		flags |= SceneQuadInstanceFlag_ColorAlongX;
+	
+	if ((v3.color - v0.color).dotSelf() > 0.0f)
+		flags |= SceneQuadInstanceFlag_ColorAlongY;
+	
+	target.origin = vec4(v0.position.x, v0.position.y, xAxis.x, xAxis.y);
+	target.axis = vec4(yAxis.x, yAxis.y, packUnitFloatPair(v0.texCoord.z, v0.texCoord.w, 4095.0f, 4096.0f),
+		static_cast<float>(SceneQuadInstance_SlotsPerFlag * flags));
+	target.texCoord = vec4(v0.texCoord.x, v0.texCoord.y, v2.texCoord.x, v2.texCoord.y);
+	target.color = vec4(packUnitFloatPair(v0.color.x, v0.color.y, 255.0f, 256.0f),
+		packUnitFloatPair(v0.color.z, v0.color.w, 255.0f, 256.0f),
+		packUnitFloatPair(v2.color.x, v2.color.y, 255.0f, 256.0f),
+		packUnitFloatPair(v2.color.z, v2.color.w, 255.0f, 256.0f));
+}
+
 void et::s2d::buildQuad(SceneVertexList& vertices, const SceneVertex& topLeft, const SceneVertex& topRight,
 	const SceneVertex& bottomLeft, const SceneVertex& bottomRight)
 {
-	vertices.fitToSize(6);
+	/*
+	 * Quads are indexed with shared static pattern 0, 1, 2, 0, 2, 3
+	 */
+	vertices.fitToSize(QuadGeometry_Vertices);
 	vertices.push_back(bottomLeft);
 	vertices.push_back(bottomRight);
 	vertices.push_back(topRight);
-	vertices.push_back(bottomLeft);
-	vertices.push_back(topRight);
 	vertices.push_back(topLeft);
 }
 
 void et::s2d::buildQuad(SceneVertexList& vertices, SceneVertex topLeft, SceneVertex topRight,
-	SceneVertex bottomLeft, SceneVertex bottomRight, const mat4& m)
+	SceneVertex bottomLeft, SceneVertex bottomRight, const Transform2d& m)
 {
 	topLeft.position = m * topLeft.position;
 	topRight.position = m * topRight.position;
@@ -35,7 +88,7 @@ void et::s2d::buildQuad(SceneVertexList& vertices, SceneVertex topLeft, SceneVer
 }
 
 void et::s2d::buildStringVertices(SceneVertexList& vertices, const CharDescriptorList& chars,
-	Alignment hAlign, Alignment vAlign, const vec2& pos, const vec4& color, const mat4& transform,
+	Alignment hAlign, Alignment vAlign, const vec2& pos, const vec4& color, const Transform2d& transform,
 	float lineInterval)
 {
 	if (chars.empty()) return;
@@ -74,7 +127,8 @@ void et::s2d::buildStringVertices(SceneVertexList& vertices, const CharDescripto
 	size_t lineIndex = 0;
 	line = lines.front();
 	
-	vertices.fitToSize(6 * chars.size());
+	size_t firstVertex = vertices.lastElementIndex();
+	vertices.fitToSize(QuadGeometry_Vertices * chars.size());
 	for (const CharDescriptor& desc : chars)
 	{
 		vec2 sdfParameters = desc.parameters.xy();
@@ -97,14 +151,16 @@ void et::s2d::buildStringVertices(SceneVertexList& vertices, const CharDescripto
 			vec4 charColor = desc.color * color;
 			
 			buildQuad(vertices,
-				SceneVertex(floorv(transform * topLeft), vec4(topLeftUV, sdfParameters), charColor),
-				SceneVertex(floorv(transform * topRight), vec4(topRightUV, sdfParameters), charColor),
-				SceneVertex(floorv(transform * bottomLeft), vec4(bottomLeftUV, sdfParameters), charColor),
-				SceneVertex(floorv(transform * bottomRight), vec4(bottomRightUV, sdfParameters), charColor));
+				SceneVertex(topLeft, vec4(topLeftUV, sdfParameters), charColor),
+				SceneVertex(topRight, vec4(topRightUV, sdfParameters), charColor),
+				SceneVertex(bottomLeft, vec4(bottomLeftUV, sdfParameters), charColor),
+				SceneVertex(bottomRight, vec4(bottomRightUV, sdfParameters), charColor));
 			
 			line.x += desc.originalSize.x;
 		}
 	}
+	
+	transformVertexPositions(vertices, firstVertex, transform, true);
 }
 
 size_t et::s2d::measuseVertexCountForImageDescriptor(const ImageDescriptor& desc)
@@ -122,13 +178,15 @@ size_t et::s2d::measuseVertexCountForImageDescriptor(const ImageDescriptor& desc
 	int numBorders = hasLeftSafe + hasTopSafe + hasRightSafe + hasBottomSafe;
 	int numCorners = hasLeftTopCorner + hasRightTopCorner + hasLeftBottomCorner + hasRightBottomCorner;
 
-	return 6 * (1 + numCorners + numBorders);
+	return QuadGeometry_Vertices * (1 + numCorners + numBorders);
 }
 
 void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex, const ImageDescriptor& desc,
-	const rect& p, const vec4& color, const mat4& transform)
+	const rect& p, const vec4& color, const Transform2d& transform)
 {
 	if (!tex.valid()) return;
+	
+	size_t firstVertex = vertices.lastElementIndex();
 
 	bool hasLeftSafe = desc.contentOffset.left > 0;
 	bool hasTopSafe = desc.contentOffset.top > 0;
@@ -142,7 +200,7 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 	int numBorders = hasLeftSafe + hasTopSafe + hasRightSafe + hasBottomSafe;
 	int numCorners = hasLeftTopCorner + hasRightTopCorner + hasLeftBottomCorner + hasRightBottomCorner;
 
-	vertices.fitToSize(6 * (1 + numCorners + numBorders));
+	vertices.fitToSize(QuadGeometry_Vertices * (1 + numCorners + numBorders));
 
 	vec2 mask(0.0f, 0.0f);
 
@@ -184,45 +242,45 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 	vec2 rightCenterBottomRigthUV = tex->getTexCoord( desc.origin + vec2( desc.size.x, desc.size.y - desc.contentOffset.bottom));
 
 	buildQuad(vertices, 
-		SceneVertex(transform * centerTopLeft, vec4(centerTopLeftUV, mask), color ), 
-		SceneVertex(transform * centerTopRight, vec4(centerTopRightUV, mask), color ),
-		SceneVertex(transform * centerBottomLeft, vec4(centerBottomLeftUV, mask), color ),
-		SceneVertex(transform * centerBottomRight, vec4(centerBottomRightUV, mask), color ) );
+		SceneVertex(centerTopLeft, vec4(centerTopLeftUV, mask), color ), 
+		SceneVertex(centerTopRight, vec4(centerTopRightUV, mask), color ),
+		SceneVertex(centerBottomLeft, vec4(centerBottomLeftUV, mask), color ),
+		SceneVertex(centerBottomRight, vec4(centerBottomRightUV, mask), color ) );
 
 	if (hasLeftTopCorner)
 	{
 		buildQuad(vertices, 
-			SceneVertex(transform * topLeft, vec4(topLeftUV, mask), color), 
-			SceneVertex(transform * topCenterTopLeft, vec4(topCenterTopLeftUV, mask), color), 
-			SceneVertex(transform * leftCenterTopLeft, vec4(leftCenterTopLeftUV, mask), color), 
-			SceneVertex(transform * centerTopLeft, vec4(centerTopLeftUV, mask), color) );
+			SceneVertex(topLeft, vec4(topLeftUV, mask), color), 
+			SceneVertex(topCenterTopLeft, vec4(topCenterTopLeftUV, mask), color), 
+			SceneVertex(leftCenterTopLeft, vec4(leftCenterTopLeftUV, mask), color), 
+			SceneVertex(centerTopLeft, vec4(centerTopLeftUV, mask), color) );
 	}
 
 	if (hasRightTopCorner)
 	{
 		buildQuad(vertices,
-			SceneVertex(transform * topCenterTopRight, vec4(topCenterTopRightUV, mask), color),
-			SceneVertex(transform * topRight, vec4(topRightUV, mask), color), 
-			SceneVertex(transform * centerTopRight, vec4(centerTopRightUV, mask), color), 
-			SceneVertex(transform * rightCenterTopRight, vec4(rightCenterTopRightUV, mask), color) );
+			SceneVertex(topCenterTopRight, vec4(topCenterTopRightUV, mask), color),
+			SceneVertex(topRight, vec4(topRightUV, mask), color), 
+			SceneVertex(centerTopRight, vec4(centerTopRightUV, mask), color), 
+			SceneVertex(rightCenterTopRight, vec4(rightCenterTopRightUV, mask), color) );
 	}
 
 	if (hasLeftBottomCorner)
 	{
 		buildQuad(vertices, 
-			SceneVertex(transform * leftCenterBottomLeft, vec4(leftCenterBottomLeftUV, mask), color), 
-			SceneVertex(transform * centerBottomLeft, vec4(centerBottomLeftUV, mask), color), 
-			SceneVertex(transform * bottomLeft, vec4(bottomLeftUV, mask), color), 
-			SceneVertex(transform * bottomCenterBottomLeft, vec4(bottomCenterBottomLeftUV, mask), color) );
+			SceneVertex(leftCenterBottomLeft, vec4(leftCenterBottomLeftUV, mask), color), 
+			SceneVertex(centerBottomLeft, vec4(centerBottomLeftUV, mask), color), 
+			SceneVertex(bottomLeft, vec4(bottomLeftUV, mask), color), 
+			SceneVertex(bottomCenterBottomLeft, vec4(bottomCenterBottomLeftUV, mask), color) );
 	}
 
 	if (hasRightBottomCorner)
 	{
 		buildQuad(vertices, 
-			SceneVertex(transform * centerBottomRight, vec4(centerBottomRightUV, mask), color), 
-			SceneVertex(transform * rightCenterBottomRigth, vec4(rightCenterBottomRigthUV, mask), color), 
-			SceneVertex(transform * bottomCenterBottomRigth, vec4(bottomCenterBottomRigthUV, mask), color), 
-			SceneVertex(transform * bottomRight, vec4(bottomRightUV, mask), color) );
+			SceneVertex(centerBottomRight, vec4(centerBottomRightUV, mask), color), 
+			SceneVertex(rightCenterBottomRigth, vec4(rightCenterBottomRigthUV, mask), color), 
+			SceneVertex(bottomCenterBottomRigth, vec4(bottomCenterBottomRigthUV, mask), color), 
+			SceneVertex(bottomRight, vec4(bottomRightUV, mask), color) );
 	}
 
 	if (hasTopSafe)
@@ -237,10 +295,10 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 		vec2 brUV = hasRightTopCorner ? centerTopRightUV : rightCenterTopRightUV;
 
 		buildQuad(vertices, 
-			SceneVertex(transform * tl, vec4(tlUV, mask), color),
-			SceneVertex(transform * tr, vec4(trUV, mask), color),
-			SceneVertex(transform * bl, vec4(blUV, mask), color), 
-			SceneVertex(transform * br, vec4(brUV, mask), color) );
+			SceneVertex(tl, vec4(tlUV, mask), color),
+			SceneVertex(tr, vec4(trUV, mask), color),
+			SceneVertex(bl, vec4(blUV, mask), color), 
+			SceneVertex(br, vec4(brUV, mask), color) );
 	}
 
 	if (hasLeftSafe)
@@ -255,10 +313,10 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 		vec2 brUV = hasLeftBottomCorner ? centerBottomLeftUV : bottomCenterBottomLeftUV;
 
 		buildQuad(vertices,
-			SceneVertex(transform * tl, vec4(tlUV, mask), color), 
-			SceneVertex(transform * tr, vec4(trUV, mask), color),
-			SceneVertex(transform * bl, vec4(blUV, mask), color),
-			SceneVertex(transform * br, vec4(brUV, mask), color) );
+			SceneVertex(tl, vec4(tlUV, mask), color), 
+			SceneVertex(tr, vec4(trUV, mask), color),
+			SceneVertex(bl, vec4(blUV, mask), color),
+			SceneVertex(br, vec4(brUV, mask), color) );
 	}
 
 	if (hasBottomSafe)
@@ -273,10 +331,10 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 		vec2 brUV = hasRightBottomCorner ? bottomCenterBottomRigthUV : bottomRightUV;
 
 		buildQuad(vertices,
-			SceneVertex(transform * tl, vec4(tlUV, mask), color), 
-			SceneVertex(transform * tr, vec4(trUV, mask), color), 
-			SceneVertex(transform * bl, vec4(blUV, mask), color), 
-			SceneVertex(transform * br, vec4(brUV, mask), color) );
+			SceneVertex(tl, vec4(tlUV, mask), color), 
+			SceneVertex(tr, vec4(trUV, mask), color), 
+			SceneVertex(bl, vec4(blUV, mask), color), 
+			SceneVertex(br, vec4(brUV, mask), color) );
 	}
 
 	if (hasRightSafe)
@@ -291,15 +349,76 @@ void et::s2d::buildImageVertices(SceneVertexList& vertices, const Texture::Point
 		vec2 brUV = hasRightBottomCorner ? rightCenterBottomRigthUV : bottomRightUV;
 
 		buildQuad(vertices, 
-			SceneVertex(transform * tl, vec4(tlUV, mask), color),
-			SceneVertex(transform * tr, vec4(trUV, mask), color),
-			SceneVertex(transform * bl, vec4(blUV, mask), color), 
-			SceneVertex(transform * br, vec4(brUV, mask), color) );
+			SceneVertex(tl, vec4(tlUV, mask), color),
+			SceneVertex(tr, vec4(trUV, mask), color),
+			SceneVertex(bl, vec4(blUV, mask), color), 
+			SceneVertex(br, vec4(brUV, mask), color) );
 	}
+
+	transformVertexPositions(vertices, firstVertex, transform);
+}
+
+void et::s2d::buildNineSliceImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex,
+	const ImageDescriptor& desc, const rect& p, const vec4& color, const Transform2d& transform)
+{
+	if (!tex.valid()) return;
+	
+	size_t firstVertex = vertices.lastElementIndex();
+	
+	vec2 size = absv(p.size());
+	vec2 endOrigin = desc.origin + desc.size - size;
+	
+	auto sliceTexCoord = [&tex, &desc, &endOrigin](const vec2& pos)
+		{ return vec4(tex->getTexCoord(desc.origin + pos), tex->getTexCoord(endOrigin + pos)); };
+	
+	vec2 topLeft = p.origin();
+	vec2 topRight = topLeft + vec2(size.x, 0.0f);
+	vec2 bottomLeft = topLeft + vec2(0.0f, size.y);
+	vec2 bottomRight = topLeft + size;
+	
+	buildQuad(vertices,
+		SceneVertex(topLeft, sliceTexCoord(vec2(0.0f)), color),
+		SceneVertex(topRight, sliceTexCoord(vec2(size.x, 0.0f)), color),
+		SceneVertex(bottomLeft, sliceTexCoord(vec2(0.0f, size.y)), color),
+		SceneVertex(bottomRight, sliceTexCoord(size), color));
+	
+	transformVertexPositions(vertices, firstVertex, transform);
+}
+
+vec4 et::s2d::nineSliceParameters(const Texture::Pointer& tex, const ImageDescriptor& desc)
+{
+	return vec4(tex->getTexCoord(desc.centerPartTopLeft()), tex->getTexCoord(desc.centerPartBottomRight()));
+}
+
+void et::s2d::buildTiledImageVertices(SceneVertexList& vertices, const Texture::Pointer& tex, const rect& p,
+	const vec2& repeats, const vec4& color, const Transform2d& transform)
+{
+	if (!tex.valid()) return;
+	
+	size_t firstVertex = vertices.lastElementIndex();
+	vec2 halfTexel = 0.5f * tex->texel();
+	
+	vec2 topLeft = p.origin();
+	vec2 topRight = topLeft + vec2(p.width, 0.0f);
+	vec2 bottomLeft = topLeft + vec2(0.0f, p.height);
+	vec2 bottomRight = topLeft + p.size();
+	
+	buildQuad(vertices,
+		SceneVertex(topLeft, vec4(vec2(0.0f), halfTexel), color),
+		SceneVertex(topRight, vec4(vec2(repeats.x, 0.0f), halfTexel), color),
+		SceneVertex(bottomLeft, vec4(vec2(0.0f, repeats.y), halfTexel), color),
+		SceneVertex(bottomRight, vec4(repeats, halfTexel), color));
+	
+	transformVertexPositions(vertices, firstVertex, transform);
+}
+
+vec4 et::s2d::imageTexCoordRect(const Texture::Pointer& tex, const ImageDescriptor& desc)
+{
+	return vec4(tex->getTexCoord(desc.origin), tex->getTexCoord(desc.origin + desc.size));
 }
 
 void et::s2d::buildColorVertices(SceneVertexList& vertices, const rect& p, const vec4& color,
-	const mat4& transform)
+	const Transform2d& transform)
 {
 	static const vec4 texCoord[] =
 	{
@@ -314,9 +433,172 @@ void et::s2d::buildColorVertices(SceneVertexList& vertices, const rect& p, const
 	vec2 bottomLeft = topLeft + vec2(0.0f, p.height);
 	vec2 bottomRight = bottomLeft + vec2(p.width, 0.0f);
 	
+	size_t firstVertex = vertices.lastElementIndex();
 	buildQuad(vertices,
-		SceneVertex(transform * topLeft, texCoord[0], color),
-		SceneVertex(transform * topRight, texCoord[1], color),
-		SceneVertex(transform * bottomLeft, texCoord[2], color),
-		SceneVertex(transform * bottomRight, texCoord[3], color));
+		SceneVertex(topLeft, texCoord[0], color),
+		SceneVertex(topRight, texCoord[1], color),
+		SceneVertex(bottomLeft, texCoord[2], color),
+		SceneVertex(bottomRight, texCoord[3], color));
+	
+	transformVertexPositions(vertices, firstVertex, transform);
+}
+
+void et::s2d::transformVertexPositions(SceneVertexList& vertices, size_t first, const Transform2d& transform,
+	bool snapToPixels)
+{
+	SceneVertex* v = vertices.data() + first;
+	size_t count = vertices.lastElementIndex() - first;
+	
+	/*
+	 * Plain loop over copied matrix components, so compiler keeps them in registers and vectorizes it
+	 */
+	const float ax = transform.xAxis.x;
+	const float ay = transform.xAxis.y;
+	const float bx = transform.yAxis.x;
+	const float by = transform.yAxis.y;
+	const float tx = transform.translation.x;
+	const float ty = transform.translation.y;
+	
+	for (size_t i = 0; i < count; ++i)
+	{
+		float x = v[i].position.x;
+		float y = v[i].position.y;
+		v[i].position.x = ax * x + bx * y + tx;
+		v[i].position.y = ay * x + by * y + ty;
+	}
+	
+	if (snapToPixels)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			v[i].position.x = std::floor(v[i].position.x);
+			v[i].position.y = std::floor(v[i].position.y);
+		}
+	}
+}
+
+inline SceneVertex mixSceneVertices(const SceneVertex& a, const SceneVertex& b, float t)
+{
+	return SceneVertex(a.position + (b.position - a.position) * t,
+		a.texCoord + (b.texCoord - a.texCoord) * t, a.color + (b.color - a.color) * t);
+}
+
+inline float clipParameter(float value, float from, float to)
+{
+	return (to != from) ? (value - from) / (to - from) : 0.0f;
+}
+
+et::s2d::ClipResult et::s2d::clipQuads(const SceneVertexList& source, SceneVertexList& target, const rect& clip)
+{
+	const float clipRight = clip.left + clip.width;
+	const float clipBottom = clip.top + clip.height;
+	
+	size_t visibleQuads = 0;
+	size_t clippedQuads = 0;
+	size_t numVertices = source.lastElementIndex();
+	
+	for (size_t i = 0; i < numVertices; i += QuadGeometry_Vertices)
+	{
+		const SceneVertex* q = source.data() + i;
+		vec2 minPos = q[0].position.xy();
+		vec2 maxPos = minPos;
+		for (size_t v = 1; v < QuadGeometry_Vertices; ++v)
+		{
+			minPos.x = etMin(minPos.x, q[v].position.x);
+			minPos.y = etMin(minPos.y, q[v].position.y);
+			maxPos.x = etMax(maxPos.x, q[v].position.x);
+			maxPos.y = etMax(maxPos.y, q[v].position.y);
+		}
+		
+		if ((maxPos.x <= clip.left) || (minPos.x >= clipRight) || (maxPos.y <= clip.top) || (minPos.y >= clipBottom))
+			continue;
+		
+		++visibleQuads;
+		
+		bool inside = (minPos.x >= clip.left) && (maxPos.x <= clipRight) && (minPos.y >= clip.top) && (maxPos.y <= clipBottom);
+		if (inside)
+			continue;
+		
+		bool axisAligned = (q[0].position.y == q[1].position.y) && (q[3].position.y == q[2].position.y) &&
+			(q[0].position.x == q[3].position.x) && (q[1].position.x == q[2].position.x);
+		
+		if (!axisAligned)
+			return ClipResult_RequiresScissor;
+		
+		++clippedQuads;
+	}
+	
+	if (visibleQuads == 0)
+		return ClipResult_Culled;
+	
+	if ((clippedQuads == 0) && (QuadGeometry_Vertices * visibleQuads == numVertices))
+		return ClipResult_Inside;
+	
+	target.setOffset(0);
+	target.fitToSize(QuadGeometry_Vertices * visibleQuads);
+	
+	for (size_t i = 0; i < numVertices; i += QuadGeometry_Vertices)
+	{
+		const SceneVertex* q = source.data() + i;
+		
+		/*
+		 * Quad is laid out as two rows: q[0] - q[1] and q[3] - q[2],
+		 * clipped corners are interpolated bilinearly between them
+		 */
+		float x0 = q[0].position.x;
+		float x1 = q[1].position.x;
+		float y0 = q[0].position.y;
+		float y1 = q[3].position.y;
+		
+		float cx0 = clamp(x0, clip.left, clipRight);
+		float cx1 = clamp(x1, clip.left, clipRight);
+		float cy0 = clamp(y0, clip.top, clipBottom);
+		float cy1 = clamp(y1, clip.top, clipBottom);
+		
+		if ((cx0 == cx1) || (cy0 == cy1))
+			continue;
+		
+		if ((cx0 == x0) && (cx1 == x1) && (cy0 == y0) && (cy1 == y1))
+		{
+			for (size_t v = 0; v < QuadGeometry_Vertices; ++v)
+				target.push_back(q[v]);
+			continue;
+		}
+		
+		float u0 = clipParameter(cx0, x0, x1);
+		float u1 = clipParameter(cx1, x0, x1);
+		float v0 = clipParameter(cy0, y0, y1);
+		float v1 = clipParameter(cy1, y0, y1);
+		
+		SceneVertex row0u0 = mixSceneVertices(q[0], q[1], u0);
+		SceneVertex row0u1 = mixSceneVertices(q[0], q[1], u1);
+		SceneVertex row1u0 = mixSceneVertices(q[3], q[2], u0);
+		SceneVertex row1u1 = mixSceneVertices(q[3], q[2], u1);
+		
+		target.push_back(mixSceneVertices(row0u0, row1u0, v0));
+		target.push_back(mixSceneVertices(row0u1, row1u1, v0));
+		target.push_back(mixSceneVertices(row0u1, row1u1, v1));
+		target.push_back(mixSceneVertices(row0u0, row1u0, v1));
+	}
+	
+	return ClipResult_Clipped;
+}
+
+rect et::s2d::verticesBounds(const SceneVertexList& vertices)
+{
+	size_t count = vertices.lastElementIndex();
+	if (count == 0)
+		return rect(0.0f, 0.0f, 0.0f, 0.0f);
+	
+	const SceneVertex* v = vertices.data();
+	vec2 minValue = v[0].position.xy();
+	vec2 maxValue = minValue;
+	
+	for (size_t i = 1; i < count; ++i)
+	{
+		minValue = minv(minValue, v[i].position.xy());
+		maxValue = maxv(maxValue, v[i].position.xy());
+	}
+	
+	return rect(minValue, maxValue - minValue);
 }
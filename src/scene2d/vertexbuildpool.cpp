@@ -0,0 +1,99 @@
+/*
+ * This file is part of `et engine`
+ * Copyright 2009-2013 by Sergey Reznik
+ * Please, do not modify content without approval.
+ *
+ */
+
+#include <et-ext/scene2d/vertexbuildpool.h>
+
+using namespace et;
+using namespace et::s2d;
+
+VertexBuildPool::VertexBuildPool(size_t threads) :
+	_nextJob(0)
+{
+	for (size_t i = 0; i < threads; ++i)
+		_threads.emplace_back(&VertexBuildPool::workerMain, this);
+}
+
+VertexBuildPool::~VertexBuildPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_running = false;
+	}
+	_jobsAvailable.notify_all();
+	
+	for (auto& t : _threads)
+		t.join();
+}
+
+void VertexBuildPool::run(size_t count, const Job& job)
+{
+	if (count == 0) return;
+	
+	if (_threads.empty() || (count == 1))
+	{
+		for (size_t i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+	
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		_jobsCount = count;
+		_nextJob = 0;
+		++_generation;
+	}
+	_jobsAvailable.notify_all();
+	
+	processJobs(job, count);
+	
+	/*
+	 * All jobs are taken at this point, wait for workers still processing them
+	 */
+	std::unique_lock<std::mutex> lock(_mutex);
+	_jobsFinished.wait(lock, [this]() { return _activeWorkers == 0; });
+	_job = nullptr;
+	_jobsCount = 0;
+}
+
+void VertexBuildPool::workerMain()
+{
+	size_t processedGeneration = 0;
+	
+	for (;;)
+	{
+		const Job* job = nullptr;
+		size_t count = 0;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_jobsAvailable.wait(lock, [this, processedGeneration]()
+				{ return !_running || (_generation != processedGeneration); });
+			
+			if (!_running) return;
+			
+			processedGeneration = _generation;
+			job = _job;
+			count = _jobsCount;
+			++_activeWorkers;
+		}
+		
+		if (job != nullptr)
+			processJobs(*job, count);
+		
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			--_activeWorkers;
+		}
+		_jobsFinished.notify_all();
+	}
+}
+
+void VertexBuildPool::processJobs(const Job& job, size_t count)
+{
+	for (size_t i = _nextJob++; i < count; i = _nextJob++)
+		job(i);
+}
@@ -0,0 +1,78 @@
+#include <chrono>
+#include <algorithm>
+#include <et/core/tools.h>
+#include "Benchmark.h"
+
+using namespace et;
+using namespace s2db;
+
+BenchmarkRunner::BenchmarkRunner(size_t iterations, const std::string& filter) :
+	_filter(filter), _iterations(etMax(size_t(1), iterations))
+{
+}
+
+bool BenchmarkRunner::shouldRun(const std::string& name) const
+{
+	return _filter.empty() || (name.find(_filter) != std::string::npos);
+}
+
+void BenchmarkRunner::run(const std::string& name, size_t items, std::function<void()> body)
+{
+	if (!shouldRun(name)) return;
+
+	body();
+
+	std::vector<double> samples;
+	samples.reserve(_iterations);
+
+	for (size_t i = 0; i < _iterations; ++i)
+	{
+		auto startTime = std::chrono::steady_clock::now();
+		body();
+		auto endTime = std::chrono::steady_clock::now();
+		samples.push_back(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	Result result;
+	result.name = name;
+	result.items = items;
+	result.minTime = samples.front();
+	result.maxTime = samples.back();
+	result.medianTime = samples.at(samples.size() / 2);
+
+	for (double s : samples)
+		result.meanTime += s;
+	result.meanTime /= static_cast<double>(samples.size());
+
+	log::info("%s: median %.4f ms, min %.4f ms", name.c_str(), result.medianTime, result.minTime);
+	_results.push_back(result);
+}
+
+Dictionary BenchmarkRunner::dictionary() const
+{
+	ArrayValue benchmarks;
+	for (const auto& r : _results)
+	{
+		Dictionary entry;
+		entry.setStringForKey("name", r.name);
+		entry.setIntegerForKey("iterations", _iterations);
+		entry.setIntegerForKey("items", r.items);
+		entry.setFloatForKey("min_ms", static_cast<float>(r.minTime));
+		entry.setFloatForKey("median_ms", static_cast<float>(r.medianTime));
+		entry.setFloatForKey("mean_ms", static_cast<float>(r.meanTime));
+		entry.setFloatForKey("max_ms", static_cast<float>(r.maxTime));
+
+		double itemsPerSecond = (r.medianTime > 0.0) ? 1000.0 * static_cast<double>(r.items) / r.medianTime : 0.0;
+		entry.setFloatForKey("items_per_second", static_cast<float>(itemsPerSecond));
+
+		benchmarks->content.push_back(entry);
+	}
+
+	Dictionary result;
+	result.setIntegerForKey("seed", DatasetSeed);
+	result.setArrayForKey("benchmarks", benchmarks);
+	result.setDictionaryForKey("context", _context);
+	return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <random>
+#include <functional>
+#include <et/json/json.h>
+
+namespace s2db
+{
+	/*
+	 * Datasets are generated from fixed seed, so results are comparable between builds
+	 */
+	enum : uint32_t
+	{
+		DatasetSeed = 0x5eed2d,
+	};
+
+	typedef std::mt19937 DatasetGenerator;
+
+	class BenchmarkRunner
+	{
+	public:
+		BenchmarkRunner(size_t iterations, const std::string& filter);
+
+		/*
+		 * Body is called once for warm up and then `iterations` times,
+		 * items are used to compute throughput (strings, glyphs, elements, frames)
+		 */
+		void run(const std::string& name, size_t items, std::function<void()> body);
+
+		bool shouldRun(const std::string& name) const;
+
+		void setContextValue(const std::string& key, et::Dictionary value)
+			{ _context.setDictionaryForKey(key, value); }
+
+		et::Dictionary dictionary() const;
+
+	private:
+		struct Result
+		{
+			std::string name;
+			size_t items = 0;
+			double minTime = 0.0;
+			double medianTime = 0.0;
+			double meanTime = 0.0;
+			double maxTime = 0.0;
+		};
+
+	private:
+		std::vector<Result> _results;
+		et::Dictionary _context;
+		std::string _filter;
+		size_t _iterations = 1;
+	};
+}
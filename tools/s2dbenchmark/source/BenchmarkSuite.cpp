@@ -0,0 +1,115 @@
+#include <fstream>
+#include <et/json/json.h>
+#include <et/rendering/rendercontext.h>
+#include "BenchmarkSuite.h"
+
+using namespace et;
+using namespace s2db;
+
+namespace
+{
+	const size_t warmupFrames = 3;
+	const size_t sceneElements = 512;
+
+#if (ET_PLATFORM_WIN)
+	const std::string defaultFontFace = "Tahoma";
+#elif (ET_PLATFORM_APPLE)
+	const std::string defaultFontFace = "Helvetica";
+#else
+	const std::string defaultFontFace = "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf";
+#endif
+}
+
+SuiteOptions s2db::parseSuiteOptions(const std::vector<std::string>& params)
+{
+	SuiteOptions result;
+	result.fontFace = defaultFontFace;
+
+	for (size_t i = 0; i + 1 < params.size(); ++i)
+	{
+		const auto& param = params.at(i);
+		const auto& value = params.at(i + 1);
+
+		if (param == "--output")
+			result.outputFile = value;
+		else if (param == "--iterations")
+			result.iterations = std::strtoul(value.c_str(), nullptr, 10);
+		else if (param == "--filter")
+			result.filter = value;
+		else if (param == "--font")
+			result.fontFace = value;
+	}
+
+	return result;
+}
+
+BenchmarkSuite::BenchmarkSuite(RenderContext* rc, const vec2& contextSize, const SuiteOptions& options) :
+	_rc(rc), _contextSize(contextSize), _options(options)
+{
+	_generator = s2d::CharacterGenerator::Pointer::create(rc, options.fontFace, options.fontFace);
+	_font = s2d::Font::Pointer::create(_generator);
+
+	_backend = s2d::RecordingRenderBackend::Pointer::create();
+	_scene = createScene(_backend);
+
+	_sceneLayout = createSceneBenchmarkLayout(_font, contextSize, sceneElements);
+	_scene->pushLayout(_sceneLayout);
+
+	_checkBackend = QuadCountingBackend::Pointer::create();
+	_checkScene = createScene(_checkBackend);
+
+	_checkLayout = createPersistentGrowthLayout();
+	_checkScene->pushLayout(_checkLayout);
+}
+
+s2d::Scene::Pointer BenchmarkSuite::createScene(const s2d::RenderBackend::Pointer& backend)
+{
+	if (_rc == nullptr)
+		return s2d::Scene::Pointer::create(_contextSize, backend);
+
+	auto scene = s2d::Scene::Pointer::create(_rc);
+	scene->setRenderBackend(backend);
+	return scene;
+}
+
+void BenchmarkSuite::renderWarmupFrame()
+{
+	_scene->render(_rc);
+	_checkScene->render(_rc);
+	++_framesRendered;
+}
+
+bool BenchmarkSuite::warmedUp() const
+{
+	return _framesRendered >= warmupFrames;
+}
+
+bool BenchmarkSuite::run()
+{
+	BenchmarkRunner runner(_options.iterations, _options.filter);
+
+	bool persistentGrowth = checkPersistentGrowth(_rc, _checkScene, _checkLayout, _checkBackend);
+
+	Dictionary checks;
+	checks.setIntegerForKey("persistent_growth", persistentGrowth);
+	runner.setContextValue("checks", checks);
+
+	runVertexBuilderBenchmarks(runner, _font);
+	runFontBenchmarks(runner, _font);
+	runSignedDistanceFieldBenchmarks(runner, _generator);
+	runHitTestBenchmarks(runner, _contextSize);
+	runAutoLayoutBenchmarks(runner, _contextSize);
+	runSceneRenderBenchmarks(runner, _rc, _scene, _sceneLayout, _backend);
+
+	std::ofstream fOut(_options.outputFile, std::ios::out);
+	fOut << json::serialize(runner.dictionary(), json::SerializationFlag_ReadableFormat);
+	fOut.flush();
+	fOut.close();
+
+	log::info("Benchmark results written to %s", _options.outputFile.c_str());
+
+	if (!persistentGrowth)
+		log::error("Some of the checks failed, see `checks` in results.");
+
+	return persistentGrowth;
+}
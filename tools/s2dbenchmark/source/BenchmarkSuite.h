@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Benchmarks.h"
+#include "Checks.h"
+
+namespace s2db
+{
+	enum : int
+	{
+		ContextWidth = 1280,
+		ContextHeight = 720,
+	};
+
+	struct SuiteOptions
+	{
+		std::string outputFile = "s2dbenchmark.json";
+		std::string filter;
+		std::string fontFace;
+		size_t iterations = 32;
+	};
+
+	/*
+	 * Parses --output, --iterations, --filter and --font launch parameters
+	 */
+	SuiteOptions parseSuiteOptions(const std::vector<std::string>&);
+
+	/*
+	 * Scenes render to backends only, so suite runs with render context
+	 * or without it, when render context is null
+	 */
+	class BenchmarkSuite : public et::Shared
+	{
+	public:
+		ET_DECLARE_POINTER(BenchmarkSuite)
+
+	public:
+		BenchmarkSuite(et::RenderContext*, const et::vec2& contextSize, const SuiteOptions&);
+
+		/*
+		 * Scenes are rendered for a few frames before benchmarks start,
+		 * so pushed layouts are already attached to the scenes
+		 */
+		void renderWarmupFrame();
+
+		bool warmedUp() const;
+
+		/*
+		 * Runs checks and benchmarks, writes results and returns false if any of the checks failed
+		 */
+		bool run();
+
+	private:
+		et::s2d::Scene::Pointer createScene(const et::s2d::RenderBackend::Pointer&);
+
+	private:
+		et::RenderContext* _rc = nullptr;
+		et::vec2 _contextSize;
+		SuiteOptions _options;
+
+		et::s2d::CharacterGenerator::Pointer _generator;
+		et::s2d::Font::Pointer _font;
+		et::s2d::Scene::Pointer _scene;
+		et::s2d::Layout::Pointer _sceneLayout;
+		et::s2d::RecordingRenderBackend::Pointer _backend;
+		et::s2d::Scene::Pointer _checkScene;
+		et::s2d::Layout::Pointer _checkLayout;
+		QuadCountingBackend::Pointer _checkBackend;
+
+		size_t _framesRendered = 0;
+	};
+}
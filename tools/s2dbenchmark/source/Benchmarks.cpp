@@ -0,0 +1,406 @@
+#include <et/core/conversion.h>
+#include "Benchmarks.h"
+
+using namespace et;
+using namespace s2db;
+
+namespace
+{
+	enum : uint32_t
+	{
+		StringsPerDataset = 256,
+		HitTestPoints = 1024,
+	};
+
+	const float benchmarkFontSize = 18.0f;
+	const float ninePatchOffset = 8.0f;
+
+	class HitTestLayout : public s2d::Layout
+	{
+	public:
+		ET_DECLARE_POINTER(HitTestLayout)
+
+	public:
+		s2d::Element2d::Pointer hitTest(const PointerInputInfo& p)
+			{ return activeElement(p); }
+	};
+
+	void appendUtf8(std::string& s, uint32_t c)
+	{
+		if (c < 0x80)
+		{
+			s.push_back(static_cast<char>(c));
+		}
+		else if (c < 0x800)
+		{
+			s.push_back(static_cast<char>(0xc0 | (c >> 6)));
+			s.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+		}
+		else
+		{
+			s.push_back(static_cast<char>(0xe0 | (c >> 12)));
+			s.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3f)));
+			s.push_back(static_cast<char>(0x80 | (c & 0x3f)));
+		}
+	}
+
+	StringList asciiDataset(DatasetGenerator& gen)
+	{
+		static const std::string alphabet = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 .,:;!?";
+		std::uniform_int_distribution<size_t> length(8, 96);
+		std::uniform_int_distribution<size_t> character(0, alphabet.size() - 1);
+
+		StringList result;
+		for (size_t i = 0; i < StringsPerDataset; ++i)
+		{
+			std::string s;
+			for (size_t c = 0, e = length(gen); c < e; ++c)
+				s.push_back(alphabet.at(character(gen)));
+			result.push_back(s);
+		}
+		return result;
+	}
+
+	StringList cjkDataset(DatasetGenerator& gen)
+	{
+		std::uniform_int_distribution<size_t> length(4, 48);
+		std::uniform_int_distribution<uint32_t> character(0x4e00, 0x4fff);
+
+		StringList result;
+		for (size_t i = 0; i < StringsPerDataset; ++i)
+		{
+			std::string s;
+			for (size_t c = 0, e = length(gen); c < e; ++c)
+				appendUtf8(s, character(gen));
+			result.push_back(s);
+		}
+		return result;
+	}
+
+	StringList markupDataset(DatasetGenerator& gen)
+	{
+		static const char* openTags[] = { "<b>", "<color=#ff8000>", "<scale=1.5>", "<offset=2.0>" };
+		static const char* closeTags[] = { "</b>", "</color>", "</scale>", "</offset>" };
+
+		std::uniform_int_distribution<size_t> words(4, 24);
+		std::uniform_int_distribution<size_t> tag(0, 3);
+
+		StringList ascii = asciiDataset(gen);
+		StringList result;
+		for (const auto& source : ascii)
+		{
+			std::string s;
+			for (size_t w = 0, e = etMin(words(gen), source.size()); w < e; ++w)
+			{
+				size_t t = tag(gen);
+				s.append(openTags[t]);
+				s.push_back(source.at(w));
+				s.append("word");
+				s.append(closeTags[t]);
+				s.push_back(' ');
+			}
+			result.push_back(s);
+		}
+		return result;
+	}
+
+	size_t totalLength(const StringList& strings)
+	{
+		size_t result = 0;
+		for (const auto& s : strings)
+			result += s.size();
+		return result;
+	}
+
+	void buildDeepTree(s2d::Element2d* parent, size_t depth, size_t siblings, DatasetGenerator& gen)
+	{
+		std::uniform_real_distribution<float> position(0.0f, 0.25f);
+
+		s2d::Element2d* next = nullptr;
+		vec2 parentSize = parent->size();
+		for (size_t i = 0; i < siblings; ++i)
+		{
+			auto e = s2d::ImageView::Pointer::create(parent);
+			e->setPosition(parentSize * vec2(position(gen), position(gen)));
+			e->setSize(0.75f * parentSize);
+			next = e.ptr();
+		}
+
+		if ((depth > 1) && (next != nullptr))
+			buildDeepTree(next, depth - 1, siblings, gen);
+	}
+
+	size_t buildWideTree(s2d::Element2d* parent, size_t count, size_t fanOut, DatasetGenerator& gen)
+	{
+		std::uniform_real_distribution<float> value(0.0f, 0.5f);
+
+		std::vector<s2d::Element2d*> level = { parent };
+		size_t created = 0;
+		while (created < count)
+		{
+			std::vector<s2d::Element2d*> nextLevel;
+			for (auto p : level)
+			{
+				for (size_t i = 0; (i < fanOut) && (created < count); ++i, ++created)
+				{
+					auto e = s2d::ImageView::Pointer::create(p);
+					e->setAutolayoutRelativeToParent(vec2(value(gen), value(gen)), vec2(0.5f + value(gen)), vec2(0.0f));
+					nextLevel.push_back(e.ptr());
+				}
+			}
+			level.swap(nextLevel);
+		}
+		return created;
+	}
+
+	void invalidateTree(s2d::Element2d* e)
+	{
+		e->invalidateContent();
+		for (auto& c : e->children())
+			invalidateTree(c.ptr());
+	}
+}
+
+void s2db::runVertexBuilderBenchmarks(BenchmarkRunner& runner, const s2d::Font::Pointer& font)
+{
+	DatasetGenerator gen(DatasetSeed);
+	StringList strings = asciiDataset(gen);
+
+	std::vector<s2d::CharDescriptorList> chars;
+	for (const auto& s : strings)
+		chars.push_back(font->buildString(s, benchmarkFontSize));
+
+	s2d::SceneVertexList vertices;
+	s2d::Transform2d transform;
+
+	runner.run("build_string_vertices", totalLength(strings), [&]()
+	{
+		vertices.setOffset(0);
+		for (const auto& c : chars)
+			s2d::buildStringVertices(vertices, c, s2d::Alignment_Near, s2d::Alignment_Near, vec2(0.0f), vec4(1.0f), transform);
+	});
+
+	std::uniform_real_distribution<float> coord(0.0f, 1024.0f);
+	std::uniform_real_distribution<float> extent(32.0f, 256.0f);
+
+	std::vector<rect> rects;
+	for (size_t i = 0; i < StringsPerDataset; ++i)
+		rects.push_back(rect(coord(gen), coord(gen), extent(gen), extent(gen)));
+
+	const auto& texture = font->generator()->texture();
+	for (uint32_t mask = 0; mask < 16; ++mask)
+	{
+		s2d::ContentOffset offset((mask & 1) ? ninePatchOffset : 0.0f, (mask & 2) ? ninePatchOffset : 0.0f,
+			(mask & 4) ? ninePatchOffset : 0.0f, (mask & 8) ? ninePatchOffset : 0.0f);
+
+		s2d::ImageDescriptor desc(vec2(0.0f), vec2(64.0f), offset);
+
+		std::string name = "build_image_vertices_";
+		name.push_back((mask & 1) ? 'L' : '-');
+		name.push_back((mask & 2) ? 'T' : '-');
+		name.push_back((mask & 4) ? 'R' : '-');
+		name.push_back((mask & 8) ? 'B' : '-');
+
+		runner.run(name, rects.size(), [&]()
+		{
+			vertices.setOffset(0);
+			for (const auto& r : rects)
+				s2d::buildImageVertices(vertices, texture, desc, r, vec4(1.0f), transform);
+		});
+	}
+
+	runner.run("build_color_vertices", rects.size(), [&]()
+	{
+		vertices.setOffset(0);
+		for (const auto& r : rects)
+			s2d::buildColorVertices(vertices, r, vec4(1.0f), transform);
+	});
+
+	s2d::Transform2d rotated(transform2DMatrix(0.25f, vec2(1.5f), vec2(100.0f)));
+	runner.run("transform_vertex_positions", vertices.lastElementIndex(), [&]()
+		{ s2d::transformVertexPositions(vertices, 0, rotated); });
+}
+
+void s2db::runFontBenchmarks(BenchmarkRunner& runner, const s2d::Font::Pointer& font)
+{
+	DatasetGenerator gen(DatasetSeed);
+
+	std::pair<std::string, StringList> datasets[] =
+	{
+		{ "ascii", asciiDataset(gen) },
+		{ "cjk", cjkDataset(gen) },
+		{ "markup", markupDataset(gen) },
+	};
+
+	for (const auto& d : datasets)
+	{
+		const StringList& strings = d.second;
+
+		runner.run("font_build_string_" + d.first, strings.size(), [&]()
+		{
+			for (const auto& s : strings)
+				font->buildString(s, benchmarkFontSize);
+		});
+
+		runner.run("font_measure_string_" + d.first, strings.size(), [&]()
+		{
+			for (const auto& s : strings)
+				font->measureStringSize(s, benchmarkFontSize);
+		});
+	}
+}
+
+void s2db::runSignedDistanceFieldBenchmarks(BenchmarkRunner& runner, const s2d::CharacterGenerator::Pointer& generator)
+{
+	int sizes[] = { 32, 64, 128, 256 };
+	for (int size : sizes)
+	{
+		/*
+		 * Synthetic glyph: ring with antialiased edges
+		 */
+		BinaryDataStorage source(size * size, 0);
+		float center = 0.5f * static_cast<float>(size);
+		float outerRadius = 0.4f * static_cast<float>(size);
+		float innerRadius = 0.2f * static_cast<float>(size);
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				float d = length(vec2(static_cast<float>(x) - center, static_cast<float>(y) - center));
+				float coverage = clamp(outerRadius - d, 0.0f, 1.0f) * clamp(d - innerRadius, 0.0f, 1.0f);
+				source[x + y * size] = static_cast<unsigned char>(255.0f * coverage);
+			}
+		}
+
+		BinaryDataStorage data(source.size(), 0);
+		runner.run("signed_distance_field_" + intToStr(size), 1, [&]()
+		{
+			etCopyMemory(data.data(), source.data(), source.dataSize());
+			generator->generateSignedDistanceField(data, size, size);
+		});
+	}
+}
+
+void s2db::runHitTestBenchmarks(BenchmarkRunner& runner, const vec2& contextSize)
+{
+	size_t depths[] = { 16, 64 };
+	for (size_t depth : depths)
+	{
+		DatasetGenerator gen(DatasetSeed);
+
+		HitTestLayout::Pointer layout = HitTestLayout::Pointer::create();
+		layout->setSize(contextSize);
+		buildDeepTree(layout.ptr(), depth, 8, gen);
+
+		std::uniform_real_distribution<float> x(0.0f, contextSize.x);
+		std::uniform_real_distribution<float> y(0.0f, contextSize.y);
+
+		std::vector<PointerInputInfo> points(HitTestPoints);
+		for (auto& p : points)
+		{
+			p.pos = vec2(x(gen), y(gen));
+			p.normalizedPos = vec2(2.0f, -2.0f) * p.pos / contextSize - vec2(1.0f, -1.0f);
+		}
+
+		runner.run("layout_active_element_depth_" + intToStr(depth), points.size(), [&]()
+		{
+			for (const auto& p : points)
+				layout->hitTest(p);
+		});
+	}
+}
+
+void s2db::runAutoLayoutBenchmarks(BenchmarkRunner& runner, const vec2& contextSize)
+{
+	size_t counts[] = { 1000, 10000 };
+	for (size_t count : counts)
+	{
+		DatasetGenerator gen(DatasetSeed);
+
+		s2d::Layout::Pointer layout = s2d::Layout::Pointer::create();
+		size_t created = buildWideTree(layout.ptr(), count, 10, gen);
+
+		/*
+		 * Alternating context size makes every pass change element frames
+		 */
+		size_t pass = 0;
+		runner.run("element_auto_layout_" + intToStr(count), created, [&]()
+		{
+			layout->autoLayout(((pass++ % 2) == 0) ? contextSize : 0.5f * contextSize);
+		});
+	}
+}
+
+s2d::Layout::Pointer s2db::createSceneBenchmarkLayout(const s2d::Font::Pointer& font, const vec2& contextSize,
+	size_t elements)
+{
+	DatasetGenerator gen(DatasetSeed);
+	StringList strings = asciiDataset(gen);
+
+	std::uniform_real_distribution<float> x(0.0f, contextSize.x);
+	std::uniform_real_distribution<float> y(0.0f, contextSize.y);
+	std::uniform_real_distribution<float> component(0.0f, 1.0f);
+
+	auto layout = s2d::Layout::Pointer::create();
+	for (size_t i = 0; i < elements; ++i)
+	{
+		if (i % 2 == 0)
+		{
+			auto image = s2d::ImageView::Pointer::create(layout.ptr());
+			image->setBackgroundColor(vec4(component(gen), component(gen), component(gen), 1.0f));
+			image->setPosition(x(gen), y(gen));
+			image->setSize(64.0f, 64.0f);
+		}
+		else
+		{
+			auto label = s2d::Label::Pointer::create(strings.at(i % strings.size()), font,
+				benchmarkFontSize, layout.ptr());
+			label->setPosition(x(gen), y(gen));
+		}
+	}
+	return layout;
+}
+
+void s2db::runSceneRenderBenchmarks(BenchmarkRunner& runner, RenderContext* rc, s2d::Scene::Pointer& scene,
+	s2d::Layout::Pointer& layout, const s2d::RecordingRenderBackend::Pointer& backend)
+{
+	runner.run("scene_render_static", layout->children().size(), [&]()
+	{
+		backend->clear();
+		scene->render(rc);
+	});
+
+	runner.run("scene_render_rebuild", layout->children().size(), [&]()
+	{
+		backend->clear();
+		invalidateTree(layout.ptr());
+		scene->render(rc);
+	});
+
+	size_t threads = std::thread::hardware_concurrency();
+	if (threads > 1)
+	{
+		scene->renderer().setVertexBuildThreads(threads - 1);
+		runner.run("scene_render_rebuild_parallel", layout->children().size(), [&]()
+		{
+			backend->clear();
+			invalidateTree(layout.ptr());
+			scene->render(rc);
+		});
+		scene->renderer().setVertexBuildThreads(0);
+	}
+
+	scene->setStatisticsEnabled(true);
+	invalidateTree(layout.ptr());
+	backend->clear();
+	scene->render(rc);
+	scene->setStatisticsEnabled(false);
+
+	Dictionary backendValues;
+	backendValues.setIntegerForKey("uploads", backend->uploads().size());
+	backendValues.setIntegerForKey("uploaded_bytes", backend->uploadedBytes());
+	backendValues.setIntegerForKey("draws", backend->draws().size());
+
+	runner.setContextValue("scene_statistics", scene->statisticsDictionary());
+	runner.setContextValue("scene_backend", backendValues);
+}
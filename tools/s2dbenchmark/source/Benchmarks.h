@@ -0,0 +1,21 @@
+#pragma once
+
+#include <et-ext/scene2d/scene.h>
+#include "Benchmark.h"
+
+namespace s2db
+{
+	void runVertexBuilderBenchmarks(BenchmarkRunner&, const et::s2d::Font::Pointer&);
+	void runFontBenchmarks(BenchmarkRunner&, const et::s2d::Font::Pointer&);
+	void runSignedDistanceFieldBenchmarks(BenchmarkRunner&, const et::s2d::CharacterGenerator::Pointer&);
+	void runHitTestBenchmarks(BenchmarkRunner&, const et::vec2& contextSize);
+	void runAutoLayoutBenchmarks(BenchmarkRunner&, const et::vec2& contextSize);
+	void runSceneRenderBenchmarks(BenchmarkRunner&, et::RenderContext*, et::s2d::Scene::Pointer&,
+		et::s2d::Layout::Pointer&, const et::s2d::RecordingRenderBackend::Pointer&);
+
+	/*
+	 * Layout populated with image views and labels, used for full frame benchmarks
+	 */
+	et::s2d::Layout::Pointer createSceneBenchmarkLayout(const et::s2d::Font::Pointer&, const et::vec2& contextSize,
+		size_t elements);
+}
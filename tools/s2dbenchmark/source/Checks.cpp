@@ -0,0 +1,109 @@
+#include "Checks.h"
+
+using namespace et;
+using namespace s2db;
+
+namespace
+{
+	/*
+	 * Each element reserves two quads, 4200 vertices exceed 4096 of default capacity
+	 */
+	const size_t persistentGrowthElements = 525;
+	const size_t persistentGrowthColumns = 32;
+}
+
+void QuadCountingBackend::uploadVertices(const s2d::RenderingElement* element, size_t offset,
+	const void* data, size_t size)
+{
+	auto& storage = _vertices[element];
+	if (storage.size() < offset + size)
+		storage.resize(offset + size);
+
+	etCopyMemory(storage.binary() + offset, data, size);
+}
+
+void QuadCountingBackend::drawChunk(const s2d::RenderingElement* element, const s2d::RenderChunk& chunk,
+	size_t firstIndex, const vec4*, size_t)
+{
+	ET_ASSERT(element->vertexFormat() == s2d::RenderingElement::VertexFormat::Default);
+
+	const auto& storage = _vertices[element];
+	auto vertices = reinterpret_cast<const s2d::SceneVertex*>(storage.binary());
+	size_t verticesCount = storage.size() / sizeof(s2d::SceneVertex);
+
+	size_t firstQuad = firstIndex / s2d::QuadGeometry_Indices;
+	size_t lastQuad = firstQuad + chunk.count / s2d::QuadGeometry_Indices;
+	for (size_t q = firstQuad; q < lastQuad; ++q)
+	{
+		size_t firstVertex = s2d::QuadGeometry_Vertices * q;
+		if (firstVertex + s2d::QuadGeometry_Vertices > verticesCount)
+			break;
+
+		/*
+		 * Unused reserve of persistent ranges is filled with zeroes
+		 */
+		bool degenerate = true;
+		for (size_t v = 0; degenerate && (v < s2d::QuadGeometry_Vertices); ++v)
+			degenerate = (vertices[firstVertex + v].position.xy().dotSelf() == 0.0f);
+
+		_drawnQuads += degenerate ? 0 : 1;
+	}
+}
+
+void QuadCountingBackend::drawInstances(const s2d::RenderingElement* element, const s2d::RenderChunk&,
+	size_t firstInstance, size_t instanceCount, const vec4*, size_t)
+{
+	ET_ASSERT(element->vertexFormat() == s2d::RenderingElement::VertexFormat::Instanced);
+
+	const auto& storage = _vertices[element];
+	auto instances = reinterpret_cast<const s2d::SceneQuadInstance*>(storage.binary());
+	size_t lastInstance = etMin(firstInstance + instanceCount, storage.size() / sizeof(s2d::SceneQuadInstance));
+
+	for (size_t i = firstInstance; i < lastInstance; ++i)
+	{
+		bool degenerate = (instances[i].origin.zw().dotSelf() == 0.0f) && (instances[i].axis.xy().dotSelf() == 0.0f);
+		_drawnQuads += degenerate ? 0 : 1;
+	}
+}
+
+s2d::Layout::Pointer s2db::createPersistentGrowthLayout()
+{
+	auto layout = s2d::Layout::Pointer::create();
+	layout->setStreamingMode(s2d::RenderingElement::StreamingMode::Persistent);
+
+	for (size_t i = 0; i < persistentGrowthElements; ++i)
+	{
+		auto image = s2d::ImageView::Pointer::create(layout.ptr());
+		image->setBackgroundColor(vec4(1.0f));
+		image->setPosition(8.0f * static_cast<float>(i % persistentGrowthColumns),
+			8.0f * static_cast<float>(i / persistentGrowthColumns));
+		image->setSize(4.0f, 4.0f);
+	}
+
+	return layout;
+}
+
+bool s2db::checkPersistentGrowth(RenderContext* rc, s2d::Scene::Pointer& scene, s2d::Layout::Pointer& layout,
+	const QuadCountingBackend::Pointer& backend)
+{
+	/*
+	 * Storage should have grown on the first frame already, so every frame draws all elements
+	 */
+	bool succeeded = (layout->vertexCapacity() > s2d::RenderingElement::DefaultCapacity);
+
+	for (size_t frame = 0; frame < 2; ++frame)
+	{
+		backend->resetDrawnQuads();
+		scene->render(rc);
+		succeeded &= (backend->drawnQuads() == persistentGrowthElements);
+	}
+
+	if (!succeeded)
+	{
+		log::error("Persistent growth check failed: capacity %llu, drawn %llu of %llu elements",
+			static_cast<uint64_t>(layout->vertexCapacity()), static_cast<uint64_t>(backend->drawnQuads()),
+			static_cast<uint64_t>(persistentGrowthElements));
+	}
+
+	return succeeded;
+}
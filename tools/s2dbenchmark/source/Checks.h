@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <et-ext/scene2d/scene.h>
+
+namespace s2db
+{
+	/*
+	 * Keeps copy of uploaded vertices and counts non-degenerate quads in submitted chunks,
+	 * expects layouts in default or instanced vertex format
+	 */
+	class QuadCountingBackend : public et::s2d::RenderBackend
+	{
+	public:
+		ET_DECLARE_POINTER(QuadCountingBackend)
+
+	public:
+		void uploadVertices(const et::s2d::RenderingElement*, size_t offset, const void* data, size_t size) override;
+
+		void drawChunk(const et::s2d::RenderingElement*, const et::s2d::RenderChunk&, size_t firstIndex,
+			const et::vec4* objectParameters, size_t objectParametersCount) override;
+
+		void drawInstances(const et::s2d::RenderingElement*, const et::s2d::RenderChunk&, size_t firstInstance,
+			size_t instanceCount, const et::vec4* objectParameters, size_t objectParametersCount) override;
+
+		void resetDrawnQuads()
+			{ _drawnQuads = 0; }
+
+		size_t drawnQuads() const
+			{ return _drawnQuads; }
+
+	private:
+		std::map<const et::s2d::RenderingElement*, et::BinaryDataStorage> _vertices;
+		size_t _drawnQuads = 0;
+	};
+
+	/*
+	 * Single-quad elements, which demand fits default capacity only without persistent range reserve
+	 */
+	et::s2d::Layout::Pointer createPersistentGrowthLayout();
+
+	/*
+	 * Layout should be already pushed to the scene, returns false if storage did not grow
+	 * or some of elements were not drawn
+	 */
+	bool checkPersistentGrowth(et::RenderContext*, et::s2d::Scene::Pointer&, et::s2d::Layout::Pointer&,
+		const QuadCountingBackend::Pointer&);
+}
@@ -0,0 +1,48 @@
+#include <et/rendering/rendercontext.h>
+#include "MainController.h"
+
+using namespace et;
+using namespace s2db;
+
+void MainController::setApplicationParameters(et::ApplicationParameters& p)
+{
+	p.windowStyle = WindowStyle_Caption;
+	p.shouldSuspendOnDeactivate = false;
+}
+
+void MainController::setRenderContextParameters(et::RenderContextParameters& p)
+{
+	p.multisamplingQuality = MultisamplingQuality_None;
+	p.contextBaseSize = vec2i(ContextWidth, ContextHeight);
+	p.contextSize = p.contextBaseSize;
+}
+
+void MainController::applicationDidLoad(et::RenderContext* rc)
+{
+	std::vector<std::string> params;
+	for (size_t i = 0, e = application().launchParamtersCount(); i < e; ++i)
+		params.push_back(application().launchParameter(i));
+
+	_suite = BenchmarkSuite::Pointer::create(rc, rc->size(), parseSuiteOptions(params));
+}
+
+void MainController::render(et::RenderContext*)
+{
+	if (!_suite->warmedUp())
+	{
+		_suite->renderWarmupFrame();
+		return;
+	}
+
+	if (!_finished)
+	{
+		_finished = true;
+		application().quit(_suite->run() ? 0 : 1);
+	}
+}
+
+ApplicationIdentifier MainController::applicationIdentifier() const
+	{ return ApplicationIdentifier(applicationIdentifierForCurrentProject(), "Cheetek", "S2DBenchmark"); }
+
+IApplicationDelegate* Application::initApplicationDelegate()
+	{ return sharedObjectFactory().createObject<MainController>(); }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <et/app/application.h>
+#include "BenchmarkSuite.h"
+
+namespace s2db
+{
+	class MainController : public et::IApplicationDelegate
+	{
+	private:
+		et::ApplicationIdentifier applicationIdentifier() const;
+
+		void setApplicationParameters(et::ApplicationParameters&);
+		void setRenderContextParameters(et::RenderContextParameters&);
+		void applicationDidLoad(et::RenderContext*);
+
+		void render(et::RenderContext*);
+
+	private:
+		BenchmarkSuite::Pointer _suite;
+		bool _finished = false;
+	};
+}
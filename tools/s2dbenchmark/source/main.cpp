@@ -0,0 +1,43 @@
+#if (S2DB_HEADLESS)
+
+#include <et/core/tools.h>
+#include <et/app/application.h>
+#include "BenchmarkSuite.h"
+
+using namespace et;
+
+/*
+ * Headless build runs scenes on render backends without window and render context,
+ * run loop is updated manually so pushed layouts are attached during warm up.
+ * Returns non-zero code if any of the checks failed
+ */
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> params(argv + 1, argv + argc);
+
+	auto suite = s2db::BenchmarkSuite::Pointer::create(nullptr,
+		vec2(static_cast<float>(s2db::ContextWidth), static_cast<float>(s2db::ContextHeight)),
+		s2db::parseSuiteOptions(params));
+
+	while (!suite->warmedUp())
+	{
+		mainRunLoop().update(queryContiniousTimeInMilliSeconds());
+		suite->renderWarmupFrame();
+	}
+
+	return suite->run() ? 0 : 1;
+}
+
+IApplicationDelegate* Application::initApplicationDelegate()
+	{ return nullptr; }
+
+#else
+
+#include "MainController.h"
+
+int main(int argc, char* argv[])
+{
+	return et::application().run(argc, argv);
+}
+
+#endif